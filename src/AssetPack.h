@@ -0,0 +1,199 @@
+// AssetPack.h - Cooked texture pack written by tools/asset_cook.cpp
+//
+// The pack holds every PNG under assets/ already decoded to RGBA8, so startup
+// uploads textures straight from the mapped file with no PNG decoding.
+//
+// Layout: PackHeader, then entry_count PackEntry records (the index, sorted by
+// path), then each entry's pixels at `offset`, 16-byte aligned. content_hash is
+// FNV-1a of the source PNG bytes; the cooker uses it to skip unchanged files.
+#pragma once
+
+extern "C" {
+    #include "raylib.h"
+}
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define ASSET_PACK_MMAP 1
+#else
+    #define ASSET_PACK_MMAP 0
+#endif
+
+static const char ASSET_PACK_MAGIC[4] = {'S', 'G', 'P', 'K'};
+static const uint32_t ASSET_PACK_VERSION = 1;
+static const char* const ASSET_PACK_PATH = "assets/assets.pack";
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+};
+
+struct PackEntry {
+    char path[120];         // Path as the game asks for it, e.g. "assets/player/Idle.png"
+    uint64_t content_hash;  // FNV-1a of the source PNG
+    uint64_t offset;        // Pixel data offset from the start of the file
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;        // raylib PixelFormat, always R8G8B8A8 for now
+    uint32_t size;          // Pixel data size in bytes
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader layout is part of the file format");
+static_assert(sizeof(PackEntry) == 152, "PackEntry layout is part of the file format");
+
+inline uint64_t fnv1a_hash(const unsigned char* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Read-only view of a whole file: mmap where available, otherwise one read into memory.
+// (windows.h clashes with raylib's names, so Windows builds take the read path.)
+class MappedFile {
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#if !ASSET_PACK_MMAP
+    std::vector<unsigned char> buffer;
+#endif
+
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#if ASSET_PACK_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        bytes = (const unsigned char*)mapped;
+        length = (size_t)st.st_size;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        std::streamsize file_size = file.tellg();
+        if (file_size <= 0) return false;
+        buffer.resize((size_t)file_size);
+        file.seekg(0);
+        if (!file.read((char*)buffer.data(), file_size)) {
+            buffer.clear();
+            return false;
+        }
+        bytes = buffer.data();
+        length = buffer.size();
+#endif
+        return true;
+    }
+
+    void close() {
+#if ASSET_PACK_MMAP
+        if (bytes) munmap((void*)bytes, length);
+#else
+        buffer.clear();
+        buffer.shrink_to_fit();
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+class AssetPack {
+private:
+    MappedFile file;
+    const PackEntry* entries = nullptr;
+    uint32_t entry_count = 0;
+
+public:
+    bool open(const std::string& path = ASSET_PACK_PATH) {
+        close();
+        if (!file.open(path)) return false;
+
+        // Validate the header and that the index and every blob lie inside the file
+        if (file.size() < sizeof(PackHeader)) return fail();
+        const PackHeader* header = (const PackHeader*)file.data();
+        if (memcmp(header->magic, ASSET_PACK_MAGIC, 4) != 0 || header->version != ASSET_PACK_VERSION) return fail();
+        if (file.size() < sizeof(PackHeader) + (size_t)header->entry_count * sizeof(PackEntry)) return fail();
+
+        entries = (const PackEntry*)(file.data() + sizeof(PackHeader));
+        entry_count = header->entry_count;
+        for (uint32_t i = 0; i < entry_count; i++) {
+            if (entries[i].offset + entries[i].size > file.size()) return fail();
+        }
+        return true;
+    }
+
+    void close() {
+        file.close();
+        entries = nullptr;
+        entry_count = 0;
+    }
+
+    bool is_open() const { return entries != nullptr; }
+    uint32_t size() const { return entry_count; }
+    size_t mapped_size() const { return file.size(); }
+    const PackEntry& entry(uint32_t index) const { return entries[index]; }
+
+    // Binary search - the cooker writes the index sorted by path
+    const PackEntry* find(const std::string& path) const {
+        const PackEntry* end = entries + entry_count;
+        const PackEntry* it = std::lower_bound(entries, end, path, [](const PackEntry& e, const std::string& p) {
+            return strncmp(e.path, p.c_str(), sizeof(e.path)) < 0;
+        });
+        if (it == end || strncmp(it->path, path.c_str(), sizeof(it->path)) != 0) return nullptr;
+        return it;
+    }
+
+    const unsigned char* pixels(const PackEntry& e) const { return file.data() + e.offset; }
+
+    // Image pointing into the mapped pack - valid while the pack is open, never unload it
+    Image view_image(const PackEntry& e) const {
+        Image image = {};
+        image.data = (void*)pixels(e);
+        image.width = (int)e.width;
+        image.height = (int)e.height;
+        image.mipmaps = 1;
+        image.format = (int)e.format;
+        return image;
+    }
+
+    // Uploads straight from the pack; returns an empty texture if the path isn't cooked
+    Texture2D load_texture(const std::string& path) const {
+        const PackEntry* e = find(path);
+        if (!e) return Texture2D{};
+        return LoadTextureFromImage(view_image(*e));
+    }
+
+private:
+    bool fail() {
+        close();
+        return false;
+    }
+};
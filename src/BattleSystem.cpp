@@ -1,6 +1,7 @@
 extern "C" {
     #include <raylib.h>
     #include <raymath.h>
+    #include <rlgl.h>
 }
 
 #include <iostream>
@@ -9,19 +10,52 @@ extern "C" {
 #include <unordered_map>
 #include <algorithm>
 #include <cmath>
+#include <cfloat>
 #include <typeinfo>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#include "CombatKernels.h"
+#include "Random.h"
+#include "AssetPack.h"
+#include "ThreadPool.h"
+#include "MemoryTracker.h"
+#include "FrameArena.h"
+#include "TimerWheel.h"
+#include "SpatialGrid.h"
+#include "IncrementalGrid.h"
+#include "BattleSystem.h"
+
+#if defined(__linux__)
+    #include <unistd.h>
+#endif
 
 // ==================== ECS ARCHITECTURE ====================
 
 // Entity: Just a unique ID
 using Entity = int;
 
-// Component base class
-class Component {
+// Component base class - allocations are charged to a per-type memory category.
+// The ticks are ECS change ticks, read by Changed<T>/Added<T> queries.
+class Component : public TrackedObject {
 public:
+    uint32_t added_tick = 0;
+    uint32_t changed_tick = 0;  // Set on add and by ECS::mark_changed
+    
     virtual ~Component() = default;
 };
 
+// "component/PositionComponent" etc., created the first time T is added
+template<typename T>
+MemoryCategory& component_category() {
+    static MemoryCategory& category =
+        MemoryTracker::instance().category("component/" + readable_type_name(typeid(T).name()));
+    return category;
+}
+
 // ==================== COMPONENTS ====================
 
 class PositionComponent : public Component {
@@ -35,6 +69,13 @@ public:
         rect = {x, y, w, h};
     }
     
+    // Returns true if the facing actually changed, so callers only mark real changes
+    bool face(bool right) {
+        if (facing_right == right) return false;
+        facing_right = right;
+        return true;
+    }
+    
     void update_rect() {
         rect.x = x;
         rect.y = y;
@@ -58,9 +99,9 @@ class HealthComponent : public Component {
 public:
     int hp, max_hp;
     bool is_dead;
-    int remove_timer;
+    bool despawn_scheduled;  // Corpse removal is on the timer wheel
     
-    HealthComponent(int max_hp) : hp(max_hp), max_hp(max_hp), is_dead(false), remove_timer(0) {}
+    HealthComponent(int max_hp) : hp(max_hp), max_hp(max_hp), is_dead(false), despawn_scheduled(false) {}
     
     void take_damage(int damage) {
         hp -= damage;
@@ -69,6 +110,11 @@ public:
             is_dead = true;
         }
     }
+    
+    void heal(int amount) {
+        if (is_dead) return;
+        hp = std::min(max_hp, hp + amount);
+    }
 };
 
 class MovementComponent : public Component {
@@ -81,144 +127,344 @@ public:
         : move_dx(0), move_dy(0), speed(speed), knockback_dx(0), knockback_dy(0) {}
 };
 
-// Animation helper class
-class Animation {
+// ==================== ANIMATION CLIPS ====================
+
+// Clip slots every unit type provides
+enum AnimClipId : uint8_t {
+    CLIP_IDLE,
+    CLIP_MOVE,
+    CLIP_ATTACK,
+    CLIP_HIT,
+    CLIP_DEATH,
+    CLIP_COUNT
+};
+
+// Immutable clip definition, shared by every unit of a type
+struct AnimationClip {
+    Texture2D spritesheet = {};       // Owned by the AnimationLibrary texture cache
+    int num_frames = 0;
+    int frame_width = 0, frame_height = 0;
+    int frame_duration = 10;          // Match backup frame duration
+    bool repeat = true;
+    std::vector<Rectangle> frames;    // Source rect for each frame
+};
+
+// All clips and sprite placement for one unit type
+struct AnimationSet {
+    AnimationClip clips[CLIP_COUNT];
+    float offsetx = 0, offsety = 0;   // Proper sprite positioning offsets from backup
+    float scale = 2.0f;
+};
+
+// Loads each spritesheet once and builds the shared animation sets
+class AnimationLibrary {
+private:
+    std::unordered_map<std::string, Texture2D> textures;
+    std::unordered_map<std::string, std::unique_ptr<AnimationSet>> sets;
+    
+    // Cooked pack from the asset_cook target, opened on the first texture request
+    AssetPack pack;
+    bool pack_checked = false;
+    
+    // Texture memory is on the GPU but still counts towards the asset budget
+    MemoryCategory& texture_memory = MemoryTracker::instance().category("assets/textures");
+    MemoryCategory& set_memory = MemoryTracker::instance().category("assets/animation_sets");
+    MemoryCategory& pack_memory = MemoryTracker::instance().category("assets/pack_mapping");
+    
 public:
-    Texture2D spritesheet;
-    Rectangle frameRec;        // Rectangle for current frame (proper raylib approach from backup)
-    int num_frames;
-    int current_frame;
-    int frame_duration;
-    int frame_timer;
-    int frame_width, frame_height;  // Changed to int for consistency with backup
-    bool repeat;
-    
-    Animation(const std::string& path, int frames, int frame_size = 135) {
-        spritesheet = LoadTexture(path.c_str());
-        num_frames = frames;
-        current_frame = 0;
-        frame_duration = 10;  // Match backup frame duration
-        frame_timer = 0;
-        repeat = true;
-        
-        if (spritesheet.id != 0) {
-            frame_width = spritesheet.width / num_frames;
-            frame_height = spritesheet.height;
-            std::cout << "Animation loaded: " << path << " (" << frames << " frames)" << std::endl;
-            std::cout << "  Frame size: " << frame_width << "x" << frame_height << std::endl;
-        } else {
-            frame_width = frame_size;
-            frame_height = frame_size;
-            std::cout << "Failed to load: " << path << std::endl;
+    bool headless = false;  // Skip texture loads when running without a window
+    bool use_pack = true;   // Fall back to decoding PNGs when false or when no pack exists
+    int loaded_from_pack = 0;
+    int loaded_from_png = 0;
+    
+    ~AnimationLibrary() {
+        for (auto& [path, texture] : textures) {
+            if (texture.id != 0) {
+                texture_memory.remove(texture_bytes(texture));
+                UnloadTexture(texture);
+            }
+        }
+        for (auto& [name, set] : sets) {
+            set_memory.remove(set_bytes(*set));
+        }
+        if (pack.is_open()) {
+            pack_memory.remove(pack.mapped_size());
         }
-        
-        // Initialize frame rectangle for first frame (from backup)
-        frameRec = { 0.0f, 0.0f, (float)frame_width, (float)frame_height };
     }
     
-    ~Animation() {
-        if (spritesheet.id != 0) {
-            UnloadTexture(spritesheet);
+    Texture2D get_texture(const std::string& path) {
+        auto it = textures.find(path);
+        if (it != textures.end()) return it->second;
+        
+        Texture2D texture = {};
+        if (headless) return texture;
+        
+        open_pack();
+        if (pack.is_open()) {
+            texture = pack.load_texture(path);
+        }
+        if (texture.id != 0) {
+            loaded_from_pack++;
+        } else {
+            texture = LoadTexture(path.c_str());
+            if (texture.id != 0) loaded_from_png++;
+        }
+        if (texture.id == 0) {
+            std::cout << "Failed to load: " << path << std::endl;
         }
+        store_texture(path, texture);
+        return texture;
     }
     
-    void update() {
-        frame_timer += 1;
-        
-        if (frame_timer >= frame_duration) {
-            frame_timer = 0;
-            current_frame += 1;
-            if (current_frame >= num_frames) {
-                if (repeat) {
-                    current_frame = 0;
-                } else {
-                    current_frame = num_frames - 1;
-                }
+    // Decodes every manifest PNG in parallel, then uploads them on this (the GL) thread.
+    // Paths already loaded or present in the cooked pack are left to get_texture.
+    void preload(const std::vector<std::string>& manifest) {
+        if (headless) return;
+        open_pack();
+        
+        std::vector<std::string> paths;
+        for (const std::string& path : manifest) {
+            if (textures.count(path) || std::find(paths.begin(), paths.end(), path) != paths.end()) continue;
+            if (pack.is_open() && pack.find(path)) continue;
+            paths.push_back(path);
+        }
+        if (paths.empty()) return;
+        
+        struct DecodedImage {
+            Image image;
+            double decode_ms;
+        };
+        std::vector<DecodedImage> decoded(paths.size());
+        
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+        size_t thread_count;
+        {
+            ThreadPool pool;
+            thread_count = pool.size();
+            for (size_t i = 0; i < paths.size(); i++) {
+                pool.submit([&paths, &decoded, i]() {
+                    auto t0 = Clock::now();
+                    decoded[i].image = LoadImage(paths[i].c_str());
+                    decoded[i].decode_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+                });
             }
+            pool.wait();
         }
+        double decode_wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
         
-        // Update frame rectangle to show current frame (from backup)
-        frameRec.x = (float)(current_frame * frame_width);
+        // GL calls stay on the main thread
+        double decode_sum_ms = 0;
+        for (size_t i = 0; i < paths.size(); i++) {
+            auto t0 = Clock::now();
+            Texture2D texture = {};
+            if (decoded[i].image.data != nullptr) {
+                texture = LoadTextureFromImage(decoded[i].image);
+                UnloadImage(decoded[i].image);
+            }
+            double upload_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            decode_sum_ms += decoded[i].decode_ms;
+            
+            if (texture.id == 0) {
+                std::cout << "Failed to load: " << paths[i] << std::endl;
+            } else {
+                loaded_from_png++;
+            }
+            store_texture(paths[i], texture);
+            std::cout << "  " << paths[i] << ": decode " << decoded[i].decode_ms
+                      << " ms, upload " << upload_ms << " ms" << std::endl;
+        }
+        std::cout << "Decoded " << paths.size() << " images on " << thread_count << " threads in "
+                  << decode_wall_ms << " ms (" << decode_sum_ms << " ms serial)" << std::endl;
     }
     
-    void reset() {
-        current_frame = 0;
-        frame_timer = 0;
-        frameRec.x = 0.0f;
+    // Square texture scaled down once at load time; the ability icons are 1024x1024,
+    // far more than an action bar slot needs to sample every frame
+    Texture2D get_icon(const std::string& path, int size) {
+        std::string key = path + "@" + std::to_string(size);
+        auto it = textures.find(key);
+        if (it != textures.end()) return it->second;
+        
+        Texture2D texture = {};
+        if (headless) return texture;
+        
+        open_pack();
+        const PackEntry* entry = pack.is_open() ? pack.find(path) : nullptr;
+        Image image = entry ? ImageCopy(pack.view_image(*entry)) : LoadImage(path.c_str());
+        if (image.data != nullptr) {
+            ImageResize(&image, size, size);
+            texture = LoadTextureFromImage(image);
+            UnloadImage(image);
+            if (entry) loaded_from_pack++;
+            else loaded_from_png++;
+        } else {
+            std::cout << "Failed to load: " << path << std::endl;
+        }
+        store_texture(key, texture);
+        return texture;
     }
     
-    // Draw method using proper raylib DrawTextureRec (from backup)
-    void draw(Vector2 position, bool facing_right = true, float scale = 2.0f) {
-        if (spritesheet.id == 0) return;  // No texture loaded
+    AnimationClip make_clip(const std::string& path, int frames, int frame_size = 135, bool repeat = true) {
+        AnimationClip clip;
+        clip.spritesheet = get_texture(path);
+        clip.num_frames = frames;
+        clip.repeat = repeat;
         
-        Rectangle destRec = { position.x, position.y, frame_width * scale, frame_height * scale };
-        Rectangle sourceRec = frameRec;
-        
-        // Flip horizontally if facing left (from backup)
-        if (!facing_right) {
-            sourceRec.width = -sourceRec.width;
+        if (clip.spritesheet.id != 0) {
+            clip.frame_width = clip.spritesheet.width / frames;
+            clip.frame_height = clip.spritesheet.height;
+        } else {
+            clip.frame_width = frame_size;
+            clip.frame_height = frame_size;
         }
         
-        DrawTexturePro(spritesheet, sourceRec, destRec, {0, 0}, 0.0f, WHITE);
+        for (int i = 0; i < frames; i++) {
+            clip.frames.push_back({(float)(i * clip.frame_width), 0.0f,
+                                   (float)clip.frame_width, (float)clip.frame_height});
+        }
+        return clip;
+    }
+    
+    // Returns the named set, or nullptr if it hasn't been defined yet
+    const AnimationSet* find(const std::string& name) const {
+        auto it = sets.find(name);
+        return it != sets.end() ? it->second.get() : nullptr;
+    }
+    
+    const AnimationSet* define(const std::string& name, std::unique_ptr<AnimationSet> set) {
+        const AnimationSet* result = set.get();
+        set_memory.add(set_bytes(*set));
+        sets[name] = std::move(set);
+        std::cout << "Animation set defined: " << name << std::endl;
+        return result;
+    }
+    
+private:
+    static size_t texture_bytes(const Texture2D& texture) {
+        return (size_t)GetPixelDataSize(texture.width, texture.height, texture.format);
+    }
+    
+    static size_t set_bytes(const AnimationSet& set) {
+        size_t bytes = sizeof(AnimationSet);
+        for (const AnimationClip& clip : set.clips) {
+            bytes += clip.frames.capacity() * sizeof(Rectangle);
+        }
+        return bytes;
+    }
+    
+    void store_texture(const std::string& path, Texture2D texture) {
+        if (texture.id != 0) texture_memory.add(texture_bytes(texture));
+        textures[path] = texture;
+    }
+    
+    void open_pack() {
+        if (!use_pack || pack_checked) return;
+        pack_checked = true;
+        if (pack.open()) {
+            pack_memory.add(pack.mapped_size());
+            std::cout << "Using asset pack " << ASSET_PACK_PATH << " (" << pack.size() << " textures)" << std::endl;
+        }
     }
 };
 
+// Per-entity playback state; clip data lives in the shared AnimationSet.
+// Playback is a function of time: the clip's start tick is stored and the frame is
+// derived from it on demand, so a clip can go unvisited (offscreen) for any number
+// of ticks and still show the right frame when sync() next runs.
 class AnimationComponent : public Component {
 public:
-    std::unique_ptr<Animation> idle_anim;
-    std::unique_ptr<Animation> move_anim;
-    std::unique_ptr<Animation> attack_anim;
-    std::unique_ptr<Animation> hit_anim;
-    std::unique_ptr<Animation> death_anim;
-    Animation* current_anim;
-    float offsetx, offsety;  // Proper sprite positioning offsets from backup
-    int scale;
+    const AnimationSet* set;
+    uint32_t start_tick;  // Battle tick the current clip started on
+    uint8_t clip;
+    uint8_t frame;        // Resolved by sync()
+    bool finished;        // Non-repeating clip on its last frame; sync() has nothing left to do
     
-    // Different offsets for different sprite types
-    void set_player_offsets() {
-        offsetx = -50.0f * scale; // Player sprite offset
-        offsety = -40.0f * scale;
-    }
+    AnimationComponent(const AnimationSet* set = nullptr, uint32_t now = 0)
+        : set(set), start_tick(now), clip(CLIP_IDLE), frame(0), finished(false) {}
     
-    void set_enemy_offsets() {
-        offsetx = -60.0f * scale; // Enemy sprites might need different offset
-        offsety = -50.0f * scale;
+    bool has_clip(uint8_t id) const {
+        return set && set->clips[id].num_frames > 0;
     }
     
-    AnimationComponent() : current_anim(nullptr), scale(2) {
-        // Proper offset calculations from backup: -50*scale, -40*scale
-        offsetx = -50.0f * scale; // -100
-        offsety = -40.0f * scale; // -80
+    bool is_drawable() const {
+        return has_clip(clip) && set->clips[clip].spritesheet.id != 0;
     }
     
     // Proper switch_anim method from backup to prevent redundant changes
-    void switch_anim(Animation* new_anim) {
-        if (current_anim == new_anim) return;  // More strict check from backup
-        current_anim = new_anim;
-        if (current_anim) {
-            current_anim->reset();
+    void switch_anim(uint8_t new_clip, uint32_t now) {
+        if (clip == new_clip || !has_clip(new_clip)) return;
+        play(new_clip, now);
+    }
+    
+    // Starts the clip from its first frame even if it is already playing
+    void play(uint8_t new_clip, uint32_t now) {
+        if (!has_clip(new_clip)) return;
+        clip = new_clip;
+        start_tick = now;
+        frame = 0;
+        finished = false;
+    }
+    
+    // Brings frame up to date with tick `now`
+    void sync(uint32_t now) {
+        if (finished || !has_clip(clip)) return;
+        const AnimationClip& c = set->clips[clip];
+        
+        uint32_t step = (now - start_tick) / (uint32_t)std::max(c.frame_duration, 1);
+        if (c.repeat) {
+            frame = (uint8_t)(step % (uint32_t)c.num_frames);
+        } else if (step >= (uint32_t)c.num_frames - 1) {
+            frame = (uint8_t)(c.num_frames - 1);
+            finished = true;
+        } else {
+            frame = (uint8_t)step;
         }
     }
     
-    void update() {
-        if (current_anim) {
-            current_anim->update();
+    // Screen area draw() covers at this position (the current clip's frame size)
+    Rectangle bounds(Vector2 position) const {
+        if (!has_clip(clip)) return {position.x, position.y, 0, 0};
+        const AnimationClip& c = set->clips[clip];
+        return {position.x + set->offsetx, position.y + set->offsety,
+                c.frame_width * set->scale, c.frame_height * set->scale};
+    }
+    
+    // Largest area any of the set's clips draws to at this position, for indexes that
+    // must stay valid when the clip changes without the unit moving
+    Rectangle max_bounds(Vector2 position) const {
+        if (!set) return {position.x, position.y, 0, 0};
+        float width = 0, height = 0;
+        for (uint8_t id = 0; id < CLIP_COUNT; id++) {
+            if (!has_clip(id)) continue;
+            width = std::max(width, set->clips[id].frame_width * set->scale);
+            height = std::max(height, set->clips[id].frame_height * set->scale);
         }
+        return {position.x + set->offsetx, position.y + set->offsety, width, height};
     }
     
+    // Draw using DrawTexturePro with the shared frame rects (from backup)
     void draw(Vector2 position, bool facing_right) {
-        if (current_anim) {
-            // Use proper offset positioning from backup
-            Vector2 draw_pos = { position.x + offsetx, position.y + offsety };
-            current_anim->draw(draw_pos, facing_right, scale);
+        if (!is_drawable()) return;
+        const AnimationClip& c = set->clips[clip];
+        
+        Vector2 draw_pos = { position.x + set->offsetx, position.y + set->offsety };
+        Rectangle destRec = { draw_pos.x, draw_pos.y, c.frame_width * set->scale, c.frame_height * set->scale };
+        Rectangle sourceRec = c.frames[frame];
+        
+        // Flip horizontally if facing left (from backup)
+        if (!facing_right) {
+            sourceRec.width = -sourceRec.width;
         }
+        
+        DrawTexturePro(c.spritesheet, sourceRec, destRec, {0, 0}, 0.0f, WHITE);
     }
 };
 
 class AttackComponent : public Component {
 public:
     int cooldown;
-    int cooldown_timer;
+    bool on_cooldown;          // Cleared by a TIMER_ATTACK_READY event
+    uint32_t cooldown_serial;  // Identifies the current cooldown's ready event
     int damage;
     float range;
     int duration;
@@ -227,11 +473,11 @@ public:
     bool is_attacking;
     
     AttackComponent(int cd = 60, int dmg = 10, float rng = 120, int dur = 30, int swing = 15) 
-        : cooldown(cd), cooldown_timer(0), damage(dmg), range(rng), 
+        : cooldown(cd), on_cooldown(false), cooldown_serial(0), damage(dmg), range(rng), 
           duration(dur), duration_timer(0), swing_frame(swing), is_attacking(false) {}
     
     bool can_attack() {
-        return cooldown_timer <= 0 && !is_attacking;
+        return !on_cooldown && !is_attacking;
     }
     
     void start_attack() {
@@ -247,19 +493,23 @@ public:
                 duration_timer = 0;
             }
         }
-        if (cooldown_timer > 0) {
-            cooldown_timer--;
-        }
     }
     
     void cancel_attack() {
         is_attacking = false;
         duration_timer = 0;
-        cooldown_timer = 0; // Remove cooldown on cancel as specified
+        on_cooldown = false; // Remove cooldown on cancel as specified
+    }
+    
+    // Start cooldown on swing as in backup; returns the serial the ready event must carry
+    uint32_t start_cooldown() {
+        on_cooldown = true;
+        return ++cooldown_serial;
     }
     
-    void start_cooldown() {
-        cooldown_timer = cooldown;  // Start cooldown on swing as in backup
+    // A ready event from a cooldown that was cancelled and restarted is ignored
+    void finish_cooldown(uint32_t serial) {
+        if (serial == cooldown_serial) on_cooldown = false;
     }
 };
 
@@ -271,26 +521,163 @@ public:
     bool has_move_target; // Flag for movement target (like backup system)
     Vector2 move_target; // Target location for movement
     std::string type_name; // For debugging
+    bool stunned = false;  // Set by the EffectSystem
+    bool casting = false;  // Set by the AbilitySystem while a skill is active
     
     AIComponent(int side, const std::string& name = "") : side(side), target_entity(-1), has_target(false), has_move_target(false), move_target({0,0}), type_name(name) {}
 };
 
+enum StatId : uint8_t {
+    STAT_DAMAGE,               // Flat attack damage
+    STAT_SPEED_PERCENT,        // Percent of base move speed, -30 = 30% slow
+    STAT_MAX_HP                // Flat max HP
+};
+
+enum ImmunityFlags : uint8_t {
+    IMMUNE_POISON = 1 << 0,    // Blocks EFFECT_DAMAGE_OVER_TIME
+    IMMUNE_STUN = 1 << 1       // Blocks EFFECT_STUN
+};
+
+// Derived stats block. Spawned units get one up front; anything else gets it the
+// first time it receives an effect. Recomputed by the EffectSystem only when its
+// effects change.
+class StatsComponent : public Component {
+public:
+    int base_damage;        // Values from the prefab, before any effect
+    float base_speed;
+    int base_max_hp;
+    
+    int damage_bonus = 0;   // Sums of active modifiers
+    int speed_percent = 0;
+    int max_hp_bonus = 0;
+    uint8_t immunities = 0; // ImmunityFlags
+    bool stunned = false;
+    bool dirty = false;
+    
+    StatsComponent(int damage, float speed, int max_hp)
+        : base_damage(damage), base_speed(speed), base_max_hp(max_hp) {}
+    
+    void reset_modifiers() {
+        damage_bonus = 0;
+        speed_percent = 0;
+        max_hp_bonus = 0;
+        immunities = 0;
+        stunned = false;
+    }
+    
+    void add_modifier(StatId stat, int value) {
+        if (stat == STAT_DAMAGE) damage_bonus += value;
+        else if (stat == STAT_SPEED_PERCENT) speed_percent += value;
+        else if (stat == STAT_MAX_HP) max_hp_bonus += value;
+    }
+    
+    int damage() const { return std::max(0, base_damage + damage_bonus); }
+    float speed() const { return base_speed * std::max(0, 100 + speed_percent) / 100.0f; }
+    int max_hp() const { return std::max(1, base_max_hp + max_hp_bonus); }
+};
+
+// Units with Q/W/E/R skills. Only the index of the unit's slot block is stored here;
+// the slots themselves sit contiguously in the AbilitySystem.
+class AbilityComponent : public Component {
+public:
+    uint32_t block;
+    
+    explicit AbilityComponent(uint32_t block) : block(block) {}
+};
+
 // ==================== ENTITY COMPONENT SYSTEM ====================
 
+// Query filters for ECS::query. A plain component type only has to be present;
+// Changed<T> also requires T to have been added or marked changed after `since`,
+// Added<T> requires T to have been added after `since`.
+template<typename T> struct Changed {};
+template<typename T> struct Added {};
+
+// Change ticks only move forward; the signed difference keeps working across wraparound
+inline bool tick_after(uint32_t tick, uint32_t since) {
+    return (int32_t)(tick - since) > 0;
+}
+
+template<typename Term>
+struct QueryTerm {
+    using type = Term;
+    static bool accept(const Component&, uint32_t) { return true; }
+};
+
+template<typename T>
+struct QueryTerm<Changed<T>> {
+    using type = T;
+    static bool accept(const Component& c, uint32_t since) { return tick_after(c.changed_tick, since); }
+};
+
+template<typename T>
+struct QueryTerm<Added<T>> {
+    using type = T;
+    static bool accept(const Component& c, uint32_t since) { return tick_after(c.added_tick, since); }
+};
+
+// Memory categories for the ECS's own tables (component objects are charged per type)
+struct EcsEntityTableMemory { static constexpr const char* name = "ecs/entity_table"; };
+struct EcsComponentTableMemory { static constexpr const char* name = "ecs/component_tables"; };
+
 class ECS {
 private:
+    using ComponentTable = std::unordered_map<size_t, std::unique_ptr<Component>, std::hash<size_t>, std::equal_to<size_t>,
+        TrackingAllocator<std::pair<const size_t, std::unique_ptr<Component>>, EcsComponentTableMemory>>;
+    using EntityTable = std::unordered_map<Entity, ComponentTable, std::hash<Entity>, std::equal_to<Entity>,
+        TrackingAllocator<std::pair<const Entity, ComponentTable>, EcsEntityTableMemory>>;
+    
     int next_entity_id = 0;
-    std::unordered_map<Entity, std::unordered_map<size_t, std::unique_ptr<Component>>> components;
+    EntityTable components;
+    uint32_t change_tick = 1;  // Stamped on added/changed components; bumped by read_changes()
+    
+    template<typename Term>
+    static bool term_matches(const ComponentTable& comp_map, size_t type_id, uint32_t since) {
+        auto it = comp_map.find(type_id);
+        return it != comp_map.end() && QueryTerm<Term>::accept(*it->second, since);
+    }
     
 public:
     Entity create_entity() {
         return next_entity_id++;
     }
     
+    // Pre-size the entity table so bulk spawns don't rehash per unit
+    void reserve(size_t entity_count) {
+        components.reserve(entity_count);
+    }
+    
+    size_t entity_count() const {
+        return components.size();
+    }
+    
+    // Create an entity whose component table already has room for component_count entries
+    Entity create_entity(size_t component_count) {
+        Entity entity = next_entity_id++;
+        components[entity].reserve(component_count);
+        return entity;
+    }
+    
     template<typename T, typename... Args>
     void add_component(Entity entity, Args&&... args) {
         size_t type_id = typeid(T).hash_code();
-        components[entity][type_id] = std::make_unique<T>(std::forward<Args>(args)...);
+        T* component = new (component_category<T>()) T(std::forward<Args>(args)...);
+        component->added_tick = change_tick;
+        component->changed_tick = change_tick;
+        components[entity][type_id] = std::unique_ptr<T>(component);
+    }
+    
+    // Systems call this after writing to a component that others may watch with Changed<T>.
+    // Currently tracked: PositionComponent (movement, facing) and HealthComponent (hp).
+    void mark_changed(Component* component) {
+        component->changed_tick = change_tick;
+    }
+    
+    // For a reader of Changed/Added filters: returns the tick to pass as `since` on its
+    // next run. Everything changed before this call is at or below it, everything after
+    // is above it, so no change is missed between runs.
+    uint32_t read_changes() {
+        return change_tick++;
     }
     
     template<typename T>
@@ -306,9 +693,11 @@ public:
         return nullptr;
     }
     
+    // Query results live in the frame arena - use them within the frame, don't store them
     template<typename T>
-    std::vector<Entity> get_entities_with() {
-        std::vector<Entity> result;
+    std::pmr::vector<Entity> get_entities_with() {
+        std::pmr::vector<Entity> result(&frame_arena());
+        result.reserve(components.size());
         size_t type_id = typeid(T).hash_code();
         
         for (auto& [entity, comp_map] : components) {
@@ -320,8 +709,9 @@ public:
     }
     
     template<typename T1, typename T2>
-    std::vector<Entity> get_entities_with() {
-        std::vector<Entity> result;
+    std::pmr::vector<Entity> get_entities_with() {
+        std::pmr::vector<Entity> result(&frame_arena());
+        result.reserve(components.size());
         size_t type_id1 = typeid(T1).hash_code();
         size_t type_id2 = typeid(T2).hash_code();
         
@@ -335,8 +725,9 @@ public:
     }
     
     template<typename T1, typename T2, typename T3>
-    std::vector<Entity> get_entities_with() {
-        std::vector<Entity> result;
+    std::pmr::vector<Entity> get_entities_with() {
+        std::pmr::vector<Entity> result(&frame_arena());
+        result.reserve(components.size());
         size_t type_id1 = typeid(T1).hash_code();
         size_t type_id2 = typeid(T2).hash_code();
         size_t type_id3 = typeid(T3).hash_code();
@@ -351,12 +742,34 @@ public:
         return result;
     }
     
+    // Entities matching every term, e.g. query<Changed<HealthComponent>>(since) or
+    // query<PositionComponent, Added<AIComponent>>(since)
+    template<typename... Terms>
+    std::pmr::vector<Entity> query(uint32_t since) {
+        std::pmr::vector<Entity> result(&frame_arena());
+        result.reserve(components.size());
+        const size_t type_ids[] = {typeid(typename QueryTerm<Terms>::type).hash_code()...};
+        
+        for (auto& [entity, comp_map] : components) {
+            size_t term = 0;
+            bool matches = true;
+            ((matches = matches && term_matches<Terms>(comp_map, type_ids[term++], since)), ...);
+            if (matches) result.push_back(entity);
+        }
+        return result;
+    }
+    
     void remove_entity(Entity entity) {
         components.erase(entity);
     }
     
-    std::vector<Entity> get_all_entities() {
-        std::vector<Entity> result;
+    void clear() {
+        components.clear();
+    }
+    
+    std::pmr::vector<Entity> get_all_entities() {
+        std::pmr::vector<Entity> result(&frame_arena());
+        result.reserve(components.size());
         for (auto& [entity, comp_map] : components) {
             result.push_back(entity);
         }
@@ -366,15 +779,33 @@ public:
 
 // ==================== SYSTEMS ====================
 
+// Events on the battle's timer wheel, dispatched by BattleSystem::run_timers
+enum BattleTimerKind : uint8_t {
+    TIMER_DESPAWN,        // Remove a corpse
+    TIMER_ATTACK_READY    // Attack cooldown finished
+};
+
+struct BattleTimer {
+    BattleTimerKind kind;
+    Entity entity;
+    uint32_t serial;      // AttackComponent::cooldown_serial for TIMER_ATTACK_READY
+};
+
+using BattleTimers = TimerWheel<BattleTimer>;
+
 class MovementSystem {
 public:
     void update(ECS& ecs) {
         auto entities = ecs.get_entities_with<PositionComponent, MovementComponent>();
         
         for (Entity entity : entities) {
-            auto* pos = ecs.get_component<PositionComponent>(entity);
             auto* mov = ecs.get_component<MovementComponent>(entity);
             
+            // Idle units (most of a standing army) keep their position untouched
+            if (mov->move_dx == 0 && mov->move_dy == 0 && mov->knockback_dx == 0 && mov->knockback_dy == 0) continue;
+            
+            auto* pos = ecs.get_component<PositionComponent>(entity);
+            
             // Update position
             pos->x += mov->move_dx;
             pos->y += mov->move_dy;
@@ -396,31 +827,39 @@ public:
             else if (mov->move_dx < 0) pos->facing_right = false;
             
             pos->update_rect();
+            ecs.mark_changed(pos);
         }
     }
 };
 
+// Animation LOD: only units on screen are brought up to date, right before they are
+// drawn. Offscreen units cost nothing and catch up from their clip's start tick when
+// they come into view. A corpse whose death clip has finished never changes again,
+// so it is reported through on_settled once and left out of later updates.
 class AnimationSystem {
 public:
-    void update(ECS& ecs) {
-        auto entities = ecs.get_entities_with<AnimationComponent>();
-        
-        for (Entity entity : entities) {
+    int synced_last_frame = 0;
+    
+    template<typename OnSettled>
+    void update(ECS& ecs, uint32_t now, const std::vector<Entity>& animating, OnSettled&& on_settled) {
+        int synced = 0;
+        for (Entity entity : animating) {
             auto* anim = ecs.get_component<AnimationComponent>(entity);
-            if (anim->current_anim) {
-                anim->current_anim->update();
-            }
+            if (anim->finished) continue;  // Held on a one-shot clip's last frame until the next switch
+            anim->sync(now);
+            synced++;
+            if (anim->finished && anim->clip == CLIP_DEATH) on_settled(entity);
         }
+        synced_last_frame = synced;
     }
     
-    void render(ECS& ecs) {
-        auto entities = ecs.get_entities_with<PositionComponent, AnimationComponent>();
-        
-        for (Entity entity : entities) {
+    // Draws only the units the camera culling pass found visible
+    void render(ECS& ecs, const std::vector<Entity>& visible) {
+        for (Entity entity : visible) {
             auto* pos = ecs.get_component<PositionComponent>(entity);
             auto* anim = ecs.get_component<AnimationComponent>(entity);
             
-            if (anim->current_anim && anim->current_anim->spritesheet.id != 0) {
+            if (anim->is_drawable()) {
                 // Use the draw method from Animation class which handles proper positioning
                 Vector2 draw_pos = {pos->x, pos->y};
                 anim->draw(draw_pos, pos->facing_right);
@@ -429,10 +868,76 @@ public:
     }
 };
 
+// Spreads AI decisions (choosing a target) over frames under a time budget.
+// Deciding is the expensive part; acting on the current decision stays per frame.
+class AIScheduler {
+private:
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point deadline;
+    int made = 0;
+    
+public:
+    int budget_us = 500;       // Decision time per frame, 0 or less = every unit every frame
+    int min_decisions = 8;     // Made even over budget, so every unit is eventually revisited
+    size_t cursor = 0;         // Round-robin position, carried across frames
+    int decisions_last_frame = 0;
+    
+    void begin_frame() {
+        deadline = Clock::now() + std::chrono::microseconds(budget_us);
+        made = 0;
+    }
+    
+    // The clock is only read every 8 decisions
+    bool has_time() const {
+        if (budget_us <= 0 || made < min_decisions) return true;
+        return (made & 7) != 0 || Clock::now() < deadline;
+    }
+    
+    bool unlimited() const { return budget_us <= 0; }
+    
+    void decided() { made++; }
+    
+    void end_frame() { decisions_last_frame = made; }
+};
+
 class AttackSystem {
+private:
+    // Combined sprite width buffer for melee range, added to every attack range
+    static constexpr float SPRITE_BUFFER = 80.0f;
+    
+    // Living units of each side packed once per frame for the distance kernels
+    PackedPositions alive_by_side[2];
+    std::vector<Rectangle> alive_rects[2];  // Hit rects, parallel to alive_by_side (used for picking)
+    
+    std::vector<Entity> undecided;  // Enemies that idled without a target this frame (read next frame)
+    uint32_t now = 0;               // Battle tick, for animation start times
+    
 public:
-    void update(ECS& ecs) {
+    bool verbose = true;  // Per-unit combat logging; off for stress runs
+    AIScheduler scheduler;
+    
+    // This frame's living units of one side, as packed before attacks resolved
+    const PackedPositions& alive_units(int side) const { return alive_by_side[side]; }
+    const std::vector<Rectangle>& alive_unit_rects(int side) const { return alive_rects[side]; }
+    
+    // Sizes the per-frame unit buffers at spawn time so frames never grow them.
+    // undecided outlives the frame, so it can't come from the frame arena.
+    void reserve_units(size_t unit_count) {
+        if (undecided.capacity() >= unit_count) return;
+        size_t n = std::max(unit_count, undecided.capacity() * 2);
+        undecided.reserve(n);
+        for (int side = 0; side < 2; side++) {
+            alive_by_side[side].reserve(n);
+            alive_rects[side].reserve(n);
+        }
+    }
+    
+    void update(ECS& ecs, BattleTimers& timers) {
+        now = (uint32_t)timers.now();
+        pack_alive_units(ecs);
+        
         auto entities = ecs.get_entities_with<PositionComponent, AttackComponent, AIComponent>();
+        run_decisions(ecs, entities);
         
         for (Entity entity : entities) {
             auto* pos = ecs.get_component<PositionComponent>(entity);
@@ -445,12 +950,12 @@ public:
             attack->update_attack();
             
             // Your core logic implementation (the fundamental flow)
-            execute_core_logic(ecs, entity, pos, attack, ai, mov, anim);
+            execute_core_logic(ecs, timers, entity, pos, attack, ai, mov, anim);
         }
     }
     
 private:
-    void execute_core_logic(ECS& ecs, Entity entity, PositionComponent* pos, 
+    void execute_core_logic(ECS& ecs, BattleTimers& timers, Entity entity, PositionComponent* pos, 
                           AttackComponent* attack, AIComponent* ai, 
                           MovementComponent* mov, AnimationComponent* anim) {
         
@@ -468,17 +973,36 @@ private:
                 mov->move_dy = 0;
             }
             // Force death animation
-            if (anim && anim->death_anim) {
-                anim->switch_anim(anim->death_anim.get());
+            if (anim) {
+                anim->switch_anim(CLIP_DEATH, now);
             }
             return;  // Skip all other processing for dead units
         }
         
-        // Enemy AI - find player target
-        if (ai->side == 1) {
-            find_closest_target(ecs, entity, pos, ai, 0); // Find player targets
+        // Stunned units stand still and drop any attack in progress
+        if (ai->stunned) {
+            if (attack->is_attacking) attack->cancel_attack();
+            if (mov) {
+                mov->move_dx = 0;
+                mov->move_dy = 0;
+            }
+            if (anim) {
+                anim->switch_anim(CLIP_HIT, now);
+            }
+            return;
+        }
+        
+        // Skills root the caster; the AbilitySystem owns its animation until the cast ends
+        if (ai->casting) {
+            if (mov) {
+                mov->move_dx = 0;
+                mov->move_dy = 0;
+            }
+            return;
         }
         
+        // Enemy targets are chosen by run_decisions; from here on the unit just acts on them
+        
         // Core flow: check for movement target first (like backup system)
         if (!ai->has_target && ai->has_move_target) {
             // Movement to location logic (like backup system)
@@ -490,11 +1014,12 @@ private:
             if (distance <= mov->speed) {
                 // Reached target - stop moving
                 pos->set_from_center_bottom(target.x, target.y);
+                ecs.mark_changed(pos);
                 ai->has_move_target = false;
                 mov->move_dx = 0;
                 mov->move_dy = 0;
-                if (anim && anim->idle_anim) {
-                    anim->switch_anim(anim->idle_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_IDLE, now);
                 }
             } else {
                 // Move towards target
@@ -502,9 +1027,9 @@ private:
                 direction.y /= distance;
                 mov->move_dx = direction.x * mov->speed;
                 mov->move_dy = direction.y * mov->speed;
-                pos->facing_right = (direction.x > 0);
-                if (anim && anim->move_anim) {
-                    anim->switch_anim(anim->move_anim.get());
+                if (pos->face(direction.x > 0)) ecs.mark_changed(pos);
+                if (anim) {
+                    anim->switch_anim(CLIP_MOVE, now);
                 }
             }
             return;
@@ -512,12 +1037,13 @@ private:
         
         // Core flow: no target -> idle
         if (!ai->has_target) {
+            if (ai->side == 1) undecided.push_back(entity);
             if (mov) {
                 mov->move_dx = 0;
                 mov->move_dy = 0;
             }
-            if (anim && anim->idle_anim) {
-                anim->switch_anim(anim->idle_anim.get());
+            if (anim) {
+                anim->switch_anim(CLIP_IDLE, now);
             }
             return;
         }
@@ -535,57 +1061,59 @@ private:
         Vector2 current_pos = pos->get_center_bottom();
         Vector2 target_pos_cb = target_pos->get_center_bottom();
         
-        // Calculate closest edge distance considering sprite sizes
-        float sprite_buffer = 80.0f; // Combined sprite width buffer for melee range
+        // max(0, center_distance - buffer) <= range  <=>  center_distance^2 <= (range + buffer)^2
         float dx = target_pos_cb.x - current_pos.x;
         float dy = target_pos_cb.y - current_pos.y;
-        float center_distance = sqrt(dx*dx + dy*dy);
-        float distance = fmax(0, center_distance - sprite_buffer); // More forgiving range
+        float reach = attack->range + SPRITE_BUFFER;
+        bool in_range = (dx*dx + dy*dy) <= reach * reach;
         
         // During auto attack - check range and target death, cancel if needed
         if (attack->is_attacking) {
-            if (distance > attack->range) {
+            if (!in_range) {
                 // Out of range - cancel and remove cooldown
                 attack->cancel_attack();
-                if (anim && anim->idle_anim) {
-                    anim->switch_anim(anim->idle_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_IDLE, now);
                 }
             } else if (target_health->is_dead) {
                 // Target died during attack - cancel and go idle
                 attack->cancel_attack();
-                if (anim && anim->idle_anim) {
-                    anim->switch_anim(anim->idle_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_IDLE, now);
                 }
-                std::cout << ai->type_name << " stops attacking - target is dead" << std::endl;
+                if (verbose) std::cout << ai->type_name << " stops attacking - target is dead" << std::endl;
             } else {
                 // Deal damage at swing frame
                 if (attack->duration_timer == attack->swing_frame) {
                     target_health->take_damage(attack->damage);
-                    attack->start_cooldown(); // Use the method from AttackComponent
-                    std::cout << ai->type_name << " hits target for " << attack->damage << " damage!" << std::endl;
+                    ecs.mark_changed(target_health);
+                    timers.schedule(attack->cooldown, {TIMER_ATTACK_READY, entity, attack->start_cooldown()});
+                    if (verbose) std::cout << ai->type_name << " hits target for " << attack->damage << " damage!" << std::endl;
                 }
             }
             return; // Keep attacking if in range and target alive
         }
         
         // Check if auto attack in range
-        if (distance <= attack->range) {
+        if (in_range) {
             // In range - check BOTH conditions: can attack AND not currently attacking
             if (attack->can_attack()) {
                 // Initiate auto attack (both conditions met)
                 attack->start_attack();
                 
-                // DEBUG: Print bottom center positions
-                std::cout << "ATTACK DEBUG: " << ai->type_name << " at (" << current_pos.x << ", " << current_pos.y 
-                          << ") attacking target at (" << target_pos_cb.x << ", " << target_pos_cb.y << ")" << std::endl;
-                
                 // Set facing direction toward target when attacking
                 Vector2 direction_to_target = {target_pos_cb.x - current_pos.x, target_pos_cb.y - current_pos.y};
-                pos->facing_right = (direction_to_target.x > 0);
-                std::cout << "  -> " << ai->type_name << " facing_right = " << pos->facing_right << std::endl;
+                if (pos->face(direction_to_target.x > 0)) ecs.mark_changed(pos);
+                
+                // DEBUG: Print bottom center positions
+                if (verbose) {
+                    std::cout << "ATTACK DEBUG: " << ai->type_name << " at (" << current_pos.x << ", " << current_pos.y 
+                              << ") attacking target at (" << target_pos_cb.x << ", " << target_pos_cb.y << ")" << std::endl;
+                    std::cout << "  -> " << ai->type_name << " facing_right = " << pos->facing_right << std::endl;
+                }
                 
-                if (anim && anim->attack_anim) {
-                    anim->switch_anim(anim->attack_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_ATTACK, now);
                 }
             } else {
                 // In range but on cooldown - idle
@@ -593,8 +1121,8 @@ private:
                     mov->move_dx = 0;
                     mov->move_dy = 0;
                 }
-                if (anim && anim->idle_anim) {
-                    anim->switch_anim(anim->idle_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_IDLE, now);
                 }
             }
         } else {
@@ -608,21 +1136,23 @@ private:
                 if (current_pos.x < target_pos_cb.x) {
                     // Attacker is to the LEFT of target - position to left side
                     ideal_x = target_pos_cb.x - melee_distance;
-                    pos->facing_right = true; // Face RIGHT toward target
-                    std::cout << "Homing: Position LEFT of target, face RIGHT" << std::endl;
+                    if (pos->face(true)) ecs.mark_changed(pos); // Face RIGHT toward target
+                    if (verbose) std::cout << "Homing: Position LEFT of target, face RIGHT" << std::endl;
                 } else {
                     // Attacker is to the RIGHT of target - position to right side
                     ideal_x = target_pos_cb.x + melee_distance;
-                    pos->facing_right = false; // Face LEFT toward target
-                    std::cout << "Homing: Position RIGHT of target, face LEFT" << std::endl;
+                    if (pos->face(false)) ecs.mark_changed(pos); // Face LEFT toward target
+                    if (verbose) std::cout << "Homing: Position RIGHT of target, face LEFT" << std::endl;
                 }
                 
                 // Same bottom Y level
                 ideal_y = target_pos_cb.y;
                 
-                std::cout << "  Current: (" << current_pos.x << ", " << current_pos.y 
-                          << ") Target: (" << target_pos_cb.x << ", " << target_pos_cb.y 
-                          << ") Ideal: (" << ideal_x << ", " << ideal_y << ")" << std::endl;
+                if (verbose) {
+                    std::cout << "  Current: (" << current_pos.x << ", " << current_pos.y 
+                              << ") Target: (" << target_pos_cb.x << ", " << target_pos_cb.y 
+                              << ") Ideal: (" << ideal_x << ", " << ideal_y << ")" << std::endl;
+                }
                 
                 // Move toward ideal position
                 float move_dx = ideal_x - current_pos.x;
@@ -637,329 +1167,2378 @@ private:
                 mov->move_dx = move_dx;
                 mov->move_dy = move_dy;
                 
-                if (anim && anim->move_anim) {
-                    anim->switch_anim(anim->move_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_MOVE, now);
                 }
             }
         }
     }
     
-    void find_closest_target(ECS& ecs, Entity entity, PositionComponent* pos, AIComponent* ai, int target_side) {
-        Entity closest_target = -1;
-        float closest_distance = FLT_MAX;
-        
-        auto potential_targets = ecs.get_entities_with<PositionComponent, HealthComponent, AIComponent>();
+    // Enemy AI - find player targets. Enemies that idled last frame for lack of a
+    // target decide first; the rest continue a round-robin pass over all units.
+    void run_decisions(ECS& ecs, const std::pmr::vector<Entity>& entities) {
+        scheduler.begin_frame();
         
-        for (Entity target : potential_targets) {
-            if (target == entity) continue;
-            
-            auto* target_ai = ecs.get_component<AIComponent>(target);
-            auto* target_health = ecs.get_component<HealthComponent>(target);
-            auto* target_pos = ecs.get_component<PositionComponent>(target);
+        if (scheduler.unlimited()) {
+            for (Entity entity : entities) {
+                decide(ecs, entity);
+            }
+        } else {
+            for (Entity entity : undecided) {
+                if (!scheduler.has_time()) break;
+                decide(ecs, entity);
+            }
             
-            if (target_ai->side == target_side && !target_health->is_dead) {
-                Vector2 current_pos = pos->get_center_bottom();
-                Vector2 target_pos_cb = target_pos->get_center_bottom();
-                float dx = current_pos.x - target_pos_cb.x;
-                float dy = current_pos.y - target_pos_cb.y;
-                float center_distance = sqrt(dx*dx + dy*dy);
-                float sprite_buffer = 80.0f; // Combined sprite width buffer
-                float distance = fmax(0, center_distance - sprite_buffer); // More forgiving range
-                
-                if (distance < closest_distance) {
-                    closest_distance = distance;
-                    closest_target = target;
-                }
+            size_t count = entities.size();
+            for (size_t visited = 0; visited < count && scheduler.has_time(); visited++) {
+                decide(ecs, entities[scheduler.cursor++ % count]);
             }
         }
         
+        undecided.clear();  // Anyone skipped is still idle and queues again this frame
+        scheduler.end_frame();
+    }
+    
+    void decide(ECS& ecs, Entity entity) {
+        auto* ai = ecs.get_component<AIComponent>(entity);
+        if (!ai || ai->side != 1) return;
+        auto* health = ecs.get_component<HealthComponent>(entity);
+        if (health && health->is_dead) return;
+        
+        find_closest_target(ecs.get_component<PositionComponent>(entity), ai, 0);
+        scheduler.decided();
+    }
+    
+    void pack_alive_units(ECS& ecs) {
+        alive_by_side[0].clear();
+        alive_by_side[1].clear();
+        alive_rects[0].clear();
+        alive_rects[1].clear();
+        
+        auto units = ecs.get_entities_with<PositionComponent, HealthComponent, AIComponent>();
+        for (Entity unit : units) {
+            auto* unit_ai = ecs.get_component<AIComponent>(unit);
+            auto* unit_health = ecs.get_component<HealthComponent>(unit);
+            if (unit_health->is_dead || unit_ai->side < 0 || unit_ai->side > 1) continue;
+            
+            auto* unit_pos = ecs.get_component<PositionComponent>(unit);
+            Vector2 cb = unit_pos->get_center_bottom();
+            alive_by_side[unit_ai->side].push(unit, cb.x, cb.y);
+            alive_rects[unit_ai->side].push_back(unit_pos->rect);
+        }
+    }
+    
+    // Closest living unit of target_side by squared center-bottom distance. The old
+    // max(0, distance - SPRITE_BUFFER) score made every target within the buffer tie at
+    // 0, so the first one scanned won; now the nearest one always does.
+    void find_closest_target(PositionComponent* pos, AIComponent* ai, int target_side) {
+        const PackedPositions& candidates = alive_by_side[target_side];
+        Vector2 current_pos = pos->get_center_bottom();
+        
+        // The attacker is never in its opposing side's array, so no self check is needed
+        int best = nearest_index(current_pos.x, current_pos.y,
+                                 candidates.xs.data(), candidates.ys.data(), candidates.size());
+        Entity closest_target = (best >= 0) ? candidates.ids[best] : -1;
+        
         ai->target_entity = closest_target;
         ai->has_target = (closest_target != -1);
     }
 };
 
 class HealthSystem {
+private:
+    static const int CORPSE_FRAMES = 3000;  // Frames a corpse stays before removal
+    uint32_t last_read = 0;                 // ECS change tick of the previous update
+    
 public:
-    void update(ECS& ecs) {
-        auto entities = ecs.get_entities_with<HealthComponent>();
+    // Only units whose health changed since the last update can have just died
+    void update(ECS& ecs, BattleTimers& timers) {
+        uint32_t since = last_read;
+        last_read = ecs.read_changes();
+        auto entities = ecs.query<Changed<HealthComponent>>(since);
         
         for (Entity entity : entities) {
             auto* health = ecs.get_component<HealthComponent>(entity);
             auto* anim = ecs.get_component<AnimationComponent>(entity);
             
             if (health->is_dead) {
-                health->remove_timer++;
-                if (anim && anim->death_anim) {
-                    anim->switch_anim(anim->death_anim.get());
+                if (anim) {
+                    anim->switch_anim(CLIP_DEATH, (uint32_t)timers.now());
                 }
                 
-                if (health->remove_timer > 3000) {
-                    ecs.remove_entity(entity);
+                if (!health->despawn_scheduled) {
+                    health->despawn_scheduled = true;
+                    timers.schedule(CORPSE_FRAMES, {TIMER_DESPAWN, entity, 0});
                 }
             }
         }
     }
     
-    void render_health_bars(ECS& ecs) {
-        auto entities = ecs.get_entities_with<PositionComponent, HealthComponent>();
+    // Options for the health bar pass
+    bool hide_full_hp_bars = false;
+    
+    // Collects the bars of visible units, then submits them all after the sprites as
+    // one rlgl quad batch instead of two immediate-mode rectangles per unit
+    void render_health_bars(ECS& ecs, const std::vector<Entity>& visible) {
+        collect_health_bars(ecs, visible);
+        draw_bar_batch();
+    }
+    
+private:
+    struct BarQuad {
+        Rectangle rect;
+        Color color;
+    };
+    std::vector<BarQuad> bar_quads;  // Reused every frame
+    
+    static const int BAR_WIDTH = 50;
+    static const int BAR_HEIGHT = 5;
+    static const int QUADS_PER_BATCH = 1024;
+    
+    void collect_health_bars(ECS& ecs, const std::vector<Entity>& visible) {
+        bar_quads.clear();
         
-        for (Entity entity : entities) {
+        for (Entity entity : visible) {
             auto* pos = ecs.get_component<PositionComponent>(entity);
             auto* health = ecs.get_component<HealthComponent>(entity);
             
-            if (health->is_dead) continue;
+            if (!pos || !health || health->is_dead) continue;
+            if (hide_full_hp_bars && health->hp >= health->max_hp) continue;
+            
+            Rectangle healthbar_bg = {pos->x, pos->y - 10, (float)BAR_WIDTH, (float)BAR_HEIGHT};
+            
+            Rectangle healthbar_fg = healthbar_bg;
+            healthbar_fg.width = BAR_WIDTH * ((float)health->hp / health->max_hp);
             
-            Rectangle healthbar_bg = {pos->x, pos->y - 10, 50, 5};
-            Rectangle healthbar_fg = {pos->x, pos->y - 10, 
-                                    50 * ((float)health->hp / health->max_hp), 5};
+            bar_quads.push_back({healthbar_bg, DARKGRAY});
+            bar_quads.push_back({healthbar_fg, RED});
+        }
+    }
+    
+    void draw_bar_batch() {
+        if (bar_quads.empty()) return;
+        
+        // Untextured quads use rlgl's 1x1 white default texture, same as raylib shapes
+        rlSetTexture(rlGetTextureIdDefault());
+        for (size_t start = 0; start < bar_quads.size(); start += QUADS_PER_BATCH) {
+            size_t end = std::min(bar_quads.size(), start + (size_t)QUADS_PER_BATCH);
+            rlCheckRenderBatchLimit((int)(end - start) * 4);
             
-            DrawRectangleRec(healthbar_bg, DARKGRAY);
-            DrawRectangleRec(healthbar_fg, RED);
+            rlBegin(RL_QUADS);
+            for (size_t i = start; i < end; i++) {
+                const Rectangle& r = bar_quads[i].rect;
+                const Color& c = bar_quads[i].color;
+                rlColor4ub(c.r, c.g, c.b, c.a);
+                rlTexCoord2f(0.0f, 0.0f);
+                rlVertex2f(r.x, r.y);
+                rlTexCoord2f(0.0f, 1.0f);
+                rlVertex2f(r.x, r.y + r.height);
+                rlTexCoord2f(1.0f, 1.0f);
+                rlVertex2f(r.x + r.width, r.y + r.height);
+                rlTexCoord2f(1.0f, 0.0f);
+                rlVertex2f(r.x + r.width, r.y);
+            }
+            rlEnd();
         }
+        rlSetTexture(0);
     }
 };
 
-// ==================== BATTLE SYSTEM ====================
+// ==================== STATUS EFFECTS ====================
 
-class BattleSystem {
-private:
-    ECS ecs;
-    MovementSystem movement_system;
-    AnimationSystem animation_system;
-    AttackSystem attack_system;
-    HealthSystem health_system;
+// Effects are plain records grouped by type and ticked in one loop per type,
+// rather than one virtual Effect object per unit (docs/implementation-guide.md).
+enum EffectType : uint8_t {
+    EFFECT_DAMAGE_OVER_TIME,   // Poison: magnitude damage every period frames
+    EFFECT_HEAL_OVER_TIME,     // Regeneration: magnitude heal every period frames
+    EFFECT_STAT_MODIFIER,      // magnitude added to `stat`
+    EFFECT_STUN,               // No moving or attacking
+    EFFECT_IMMUNITY,           // magnitude is a mask of ImmunityFlags
+    EFFECT_TYPE_COUNT
+};
+
+const int EFFECT_PERMANENT = -1;  // Duration for equipment effects
+
+// Effect a hitbox applies to each unit it hits, e.g. an ability's poison.
+// Lives in shared data (AbilityDef) so hitboxes only carry a pointer.
+struct HitEffect {
+    EffectType type = EFFECT_TYPE_COUNT;  // EFFECT_TYPE_COUNT means no effect
+    int magnitude = 0;
+    int duration = 0;
+    int period = 1;
+    StatId stat = STAT_DAMAGE;
     
-public:
-    void initialize() {
-        create_test_units();
+    bool enabled() const { return type != EFFECT_TYPE_COUNT; }
+};
+
+// All active effects of one type, stored column by column
+struct EffectArray {
+    std::vector<Entity> targets;
+    std::vector<int32_t> remaining;   // Frames left, EFFECT_PERMANENT never expires
+    std::vector<int32_t> magnitude;
+    std::vector<uint16_t> period;     // Frames between ticks (over-time effects)
+    std::vector<uint16_t> timer;      // Frames until the next tick
+    std::vector<uint8_t> stat;        // StatId (stat modifiers)
+    
+    size_t size() const { return targets.size(); }
+    
+    void reserve(size_t count) {
+        targets.reserve(count);
+        remaining.reserve(count);
+        magnitude.reserve(count);
+        period.reserve(count);
+        timer.reserve(count);
+        stat.reserve(count);
     }
     
-    void update() {
+    void push(Entity target, int duration, int value, int tick_period, uint8_t stat_id) {
+        targets.push_back(target);
+        remaining.push_back(duration);
+        magnitude.push_back(value);
+        period.push_back((uint16_t)std::max(tick_period, 1));
+        timer.push_back((uint16_t)std::max(tick_period, 1));
+        stat.push_back(stat_id);
+    }
+    
+    // Order isn't meaningful, so removal moves the last effect into the hole
+    void swap_remove(size_t i) {
+        size_t last = size() - 1;
+        targets[i] = targets[last];
+        remaining[i] = remaining[last];
+        magnitude[i] = magnitude[last];
+        period[i] = period[last];
+        timer[i] = timer[last];
+        stat[i] = stat[last];
+        targets.pop_back();
+        remaining.pop_back();
+        magnitude.pop_back();
+        period.pop_back();
+        timer.pop_back();
+        stat.pop_back();
+    }
+    
+    void clear() {
+        targets.clear();
+        remaining.clear();
+        magnitude.clear();
+        period.clear();
+        timer.clear();
+        stat.clear();
+    }
+};
+
+class EffectSystem {
+private:
+    EffectArray effects[EFFECT_TYPE_COUNT];
+    std::vector<Entity> dirty;     // Units whose StatsComponent needs recomputing
+    int sweep_timer = 0;
+    
+    static const int SWEEP_INTERVAL = 60;  // Frames between removed-unit cleanups
+    
+    static bool affects_stats(EffectType type) {
+        return type == EFFECT_STAT_MODIFIER || type == EFFECT_STUN || type == EFFECT_IMMUNITY;
+    }
+    
+public:
+    // Returns false if the target is immune or isn't a unit
+    bool apply(ECS& ecs, Entity target, EffectType type, int magnitude, int duration,
+               int period = 1, StatId stat = STAT_DAMAGE) {
+        auto* health = ecs.get_component<HealthComponent>(target);
+        if (!health || health->is_dead) return false;
+        
+        StatsComponent* stats = get_or_add_stats(ecs, target);
+        if (type == EFFECT_DAMAGE_OVER_TIME && (stats->immunities & IMMUNE_POISON)) return false;
+        if (type == EFFECT_STUN && (stats->immunities & IMMUNE_STUN)) return false;
+        
+        if (type == EFFECT_IMMUNITY) {
+            // Takes effect now rather than at the next recompute, so it also blocks
+            // anything else applied this frame, and clears what it is immune to
+            stats->immunities |= (uint8_t)magnitude;
+            if (magnitude & IMMUNE_POISON) remove_effects_on(effects[EFFECT_DAMAGE_OVER_TIME], target);
+            if (magnitude & IMMUNE_STUN) remove_effects_on(effects[EFFECT_STUN], target);
+        }
+        
+        effects[type].push(target, duration, magnitude, period, stat);
+        if (affects_stats(type)) mark_dirty(stats, target);
+        return true;
+    }
+    
+    bool apply(ECS& ecs, Entity target, const HitEffect& effect) {
+        if (!effect.enabled()) return false;
+        return apply(ecs, target, effect.type, effect.magnitude, effect.duration, effect.period, effect.stat);
+    }
+    
+    size_t active_count() const {
+        size_t total = 0;
+        for (const EffectArray& array : effects) total += array.size();
+        return total;
+    }
+    
+    // Room for a couple of effects of each type per unit, so hits landing mid-frame
+    // don't grow the arrays until a fight stacks more than that
+    void reserve_units(size_t unit_count) {
+        size_t count = unit_count * 2;
+        for (EffectArray& array : effects) {
+            if (array.targets.capacity() >= count) continue;
+            array.reserve(std::max(count, array.targets.capacity() * 2));
+        }
+        if (dirty.capacity() < unit_count) dirty.reserve(std::max(unit_count, dirty.capacity() * 2));
+    }
+    
+    void clear() {
+        for (EffectArray& array : effects) array.clear();
+        dirty.clear();
+    }
+    
+    void update(ECS& ecs) {
+        tick_over_time(ecs, effects[EFFECT_DAMAGE_OVER_TIME], false);
+        tick_over_time(ecs, effects[EFFECT_HEAL_OVER_TIME], true);
+        count_down(ecs, effects[EFFECT_STAT_MODIFIER]);
+        count_down(ecs, effects[EFFECT_STUN]);
+        count_down(ecs, effects[EFFECT_IMMUNITY]);
+        
+        if (++sweep_timer >= SWEEP_INTERVAL) {
+            sweep_timer = 0;
+            sweep_removed_targets(ecs);
+        }
+        
+        if (!dirty.empty()) {
+            recompute_stats(ecs);
+        }
+    }
+    
+private:
+    StatsComponent* get_or_add_stats(ECS& ecs, Entity target) {
+        auto* stats = ecs.get_component<StatsComponent>(target);
+        if (stats) return stats;
+        
+        // Base values are captured from the unit as spawned, before any effect
+        auto* attack = ecs.get_component<AttackComponent>(target);
+        auto* mov = ecs.get_component<MovementComponent>(target);
+        auto* health = ecs.get_component<HealthComponent>(target);
+        ecs.add_component<StatsComponent>(target, attack ? attack->damage : 0, mov ? mov->speed : 0.0f,
+                                          health ? health->max_hp : 1);
+        return ecs.get_component<StatsComponent>(target);
+    }
+    
+    void mark_dirty(StatsComponent* stats, Entity target) {
+        if (stats->dirty) return;
+        stats->dirty = true;
+        dirty.push_back(target);
+    }
+    
+    void mark_dirty(ECS& ecs, Entity target) {
+        auto* stats = ecs.get_component<StatsComponent>(target);
+        if (stats) mark_dirty(stats, target);
+    }
+    
+    // Damage/heal ticks only look the target up when a tick actually fires
+    void tick_over_time(ECS& ecs, EffectArray& array, bool heal) {
+        for (size_t i = 0; i < array.size();) {
+            bool expired = false;
+            if (--array.timer[i] == 0) {
+                array.timer[i] = array.period[i];
+                auto* health = ecs.get_component<HealthComponent>(array.targets[i]);
+                if (!health || health->is_dead) {
+                    expired = true;
+                } else if (heal) {
+                    health->heal(array.magnitude[i]);
+                    ecs.mark_changed(health);
+                } else {
+                    health->take_damage(array.magnitude[i]);
+                    ecs.mark_changed(health);
+                }
+            }
+            if (array.remaining[i] != EFFECT_PERMANENT && --array.remaining[i] <= 0) expired = true;
+            
+            if (expired) {
+                array.swap_remove(i);
+            } else {
+                i++;
+            }
+        }
+    }
+    
+    void count_down(ECS& ecs, EffectArray& array) {
+        for (size_t i = 0; i < array.size();) {
+            if (array.remaining[i] != EFFECT_PERMANENT && --array.remaining[i] <= 0) {
+                mark_dirty(ecs, array.targets[i]);
+                array.swap_remove(i);
+            } else {
+                i++;
+            }
+        }
+    }
+    
+    // Linear in the array, but only runs when an immunity lands
+    static void remove_effects_on(EffectArray& array, Entity target) {
+        for (size_t i = 0; i < array.size();) {
+            if (array.targets[i] == target) {
+                array.swap_remove(i);
+            } else {
+                i++;
+            }
+        }
+    }
+    
+    // Corpses are removed by HealthSystem; drop any effects still pointing at them
+    void sweep_removed_targets(ECS& ecs) {
+        for (EffectArray& array : effects) {
+            for (size_t i = 0; i < array.size();) {
+                if (!ecs.get_component<HealthComponent>(array.targets[i])) {
+                    array.swap_remove(i);
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+    
+    // One pass over the stat-affecting arrays rebuilds every dirty unit's totals,
+    // then the derived values are written into the components systems already read.
+    // Components are looked up once per dirty unit; the pass filters effects against
+    // the sorted dirty list, so clean units' effects never touch the ECS.
+    void recompute_stats(ECS& ecs) {
+        std::sort(dirty.begin(), dirty.end());
+        std::pmr::vector<StatsComponent*> dirty_stats(&frame_arena());
+        dirty_stats.reserve(dirty.size());
+        for (Entity target : dirty) {
+            auto* stats = ecs.get_component<StatsComponent>(target);
+            if (stats) stats->reset_modifiers();
+            dirty_stats.push_back(stats);
+        }
+        
+        for (EffectType type : {EFFECT_STAT_MODIFIER, EFFECT_STUN, EFFECT_IMMUNITY}) {
+            const EffectArray& array = effects[type];
+            for (size_t i = 0; i < array.size(); i++) {
+                auto it = std::lower_bound(dirty.begin(), dirty.end(), array.targets[i]);
+                if (it == dirty.end() || *it != array.targets[i]) continue;
+                StatsComponent* stats = dirty_stats[it - dirty.begin()];
+                if (!stats) continue;
+                if (type == EFFECT_STAT_MODIFIER) {
+                    stats->add_modifier((StatId)array.stat[i], array.magnitude[i]);
+                } else if (type == EFFECT_STUN) {
+                    stats->stunned = true;
+                } else {
+                    stats->immunities |= (uint8_t)array.magnitude[i];
+                }
+            }
+        }
+        
+        for (size_t d = 0; d < dirty.size(); d++) {
+            Entity target = dirty[d];
+            StatsComponent* stats = dirty_stats[d];
+            if (!stats) continue;
+            stats->dirty = false;
+            
+            if (auto* attack = ecs.get_component<AttackComponent>(target)) {
+                attack->damage = stats->damage();
+            }
+            if (auto* mov = ecs.get_component<MovementComponent>(target)) {
+                mov->speed = stats->speed();
+            }
+            if (auto* health = ecs.get_component<HealthComponent>(target)) {
+                // Raising max HP heals by the same amount; lowering it only clamps
+                int new_max = stats->max_hp();
+                if (new_max > health->max_hp && !health->is_dead) health->hp += new_max - health->max_hp;
+                health->max_hp = new_max;
+                health->hp = std::min(health->hp, health->max_hp);
+                ecs.mark_changed(health);
+            }
+            if (auto* ai = ecs.get_component<AIComponent>(target)) {
+                ai->stunned = stats->stunned;
+            }
+        }
+        dirty.clear();
+    }
+};
+
+// ==================== HITBOXES ====================
+
+// Overflow storage for hit lists: fixed-size blocks shared by every hitbox and
+// recycled as hitboxes expire. The pool grows by doubling, so after a few fights it
+// covers the most overlapping sweeps and spills stop allocating.
+struct HitBlockPool {
+    static constexpr int BLOCK_SIZE = 32;
+    static constexpr uint32_t NONE = UINT32_MAX;
+    
+    struct Block {
+        Entity hits[BLOCK_SIZE];
+        uint32_t next;
+    };
+    std::vector<Block> blocks;
+    std::vector<uint32_t> free_blocks;
+    
+    void reserve(size_t count) {
+        blocks.reserve(count);
+        free_blocks.reserve(count);
+    }
+    
+    uint32_t acquire() {
+        uint32_t index;
+        if (!free_blocks.empty()) {
+            index = free_blocks.back();
+            free_blocks.pop_back();
+        } else {
+            index = (uint32_t)blocks.size();
+            blocks.push_back(Block{});
+            free_blocks.reserve(blocks.capacity());  // Releasing never allocates
+        }
+        blocks[index].next = NONE;
+        return index;
+    }
+    
+    void release_chain(uint32_t index) {
+        while (index != NONE) {
+            free_blocks.push_back(index);
+            index = blocks[index].next;
+        }
+    }
+    
+    void clear() {
+        blocks.clear();
+        free_blocks.clear();
+    }
+};
+
+// Entities a hitbox has already damaged. Most hitboxes touch only a handful of units,
+// so hits live in a small inline array and only spill into pooled blocks for big sweeps.
+struct HitList {
+    static constexpr int INLINE_CAPACITY = 8;
+    Entity inline_hits[INLINE_CAPACITY];
+    int count = 0;
+    uint32_t first_block = HitBlockPool::NONE;
+    uint32_t last_block = HitBlockPool::NONE;
+    
+    bool contains(Entity entity, const HitBlockPool& pool) const {
+        int n = std::min(count, INLINE_CAPACITY);
+        for (int i = 0; i < n; i++) {
+            if (inline_hits[i] == entity) return true;
+        }
+        int remaining = count - n;
+        for (uint32_t block = first_block; block != HitBlockPool::NONE; block = pool.blocks[block].next) {
+            const HitBlockPool::Block& hits = pool.blocks[block];
+            int in_block = std::min(remaining, HitBlockPool::BLOCK_SIZE);
+            for (int i = 0; i < in_block; i++) {
+                if (hits.hits[i] == entity) return true;
+            }
+            remaining -= in_block;
+        }
+        return false;
+    }
+    
+    void insert(Entity entity, HitBlockPool& pool) {
+        if (count < INLINE_CAPACITY) {
+            inline_hits[count++] = entity;
+            return;
+        }
+        int slot = (count - INLINE_CAPACITY) % HitBlockPool::BLOCK_SIZE;
+        if (slot == 0) {
+            uint32_t block = pool.acquire();
+            if (last_block == HitBlockPool::NONE) {
+                first_block = block;
+            } else {
+                pool.blocks[last_block].next = block;
+            }
+            last_block = block;
+        }
+        pool.blocks[last_block].hits[slot] = entity;
+        count++;
+    }
+    
+    void release(HitBlockPool& pool) {
+        pool.release_chain(first_block);
+        first_block = last_block = HitBlockPool::NONE;
+    }
+};
+
+// Ported from the backup Hitbox element: waits, snaps in front of its owner, then
+// damages each enemy it overlaps at most once until its duration runs out
+struct Hitbox {
+    Entity owner;
+    int side;
+    Rectangle rect;
+    float width, height;
+    int damage;
+    int heal_on_hit;     // Attacker heal per hit (Soulseer behaviour)
+    float knockback;
+    int wait;            // Frames before the hitbox becomes active
+    int duration;        // Active frames remaining
+    bool active;
+    bool remove;
+    const HitEffect* effect;  // Applied on every hit; nullptr for plain swings
+    HitList units_hit;
+};
+
+class HitboxSystem {
+private:
+    // Kept here rather than as ECS components: an owner can have several hitboxes
+    // alive at once (one per swing) and the ECS holds one component of a type per
+    // entity, each a separate heap allocation, which battle frames must avoid. The
+    // sweep also wants them packed. Hitboxes whose owner is gone are dropped in
+    // activate_pending().
+    std::vector<Hitbox> hitboxes;
+    HitBlockPool hit_blocks;      // Spilled hits of every live hitbox
+    
+    // Broadphase scratch, kept between frames to avoid reallocating
+    struct SweepBox {
+        float min_x, max_x, min_y, max_y;
+        int index;       // Hitbox index, or entity id for hurtboxes
+        int side;
+        bool is_hitbox;
+    };
+    std::vector<SweepBox> boxes;
+    std::vector<int> open_hitboxes;
+    std::vector<int> open_hurtboxes;
+    std::vector<std::pair<int, Entity>> candidate_pairs;
+    
+public:
+    bool draw_debug = false;  // Hitbox outlines, toggled with F2
+    EffectSystem* effects = nullptr;  // Receives hitbox effects; set by BattleSystem
+    
+    void spawn(Entity owner, int side, float width, float height, int damage,
+               int wait = 10, int duration = 30, int heal_on_hit = 0, float knockback = 5.0f,
+               const HitEffect* effect = nullptr) {
+        Hitbox hitbox;
+        hitbox.owner = owner;
+        hitbox.side = side;
+        hitbox.rect = {0, 0, 0, 0};
+        hitbox.width = width;
+        hitbox.height = height;
+        hitbox.damage = damage;
+        hitbox.heal_on_hit = heal_on_hit;
+        hitbox.knockback = knockback;
+        hitbox.wait = wait;
+        hitbox.duration = duration;
+        hitbox.active = false;
+        hitbox.remove = false;
+        hitbox.effect = effect;
+        hitboxes.push_back(std::move(hitbox));
+    }
+    
+    // One live hitbox per unit is the common case (a swing or a skill), with room for
+    // one block of spilled hits each
+    void reserve_units(size_t unit_count) {
+        if (hitboxes.capacity() >= unit_count) return;
+        size_t count = std::max(unit_count, hitboxes.capacity() * 2);
+        hitboxes.reserve(count);
+        hit_blocks.reserve(count);
+    }
+    
+    int active_count() const { return (int)hitboxes.size(); }
+    
+    void clear() {
+        hitboxes.clear();
+        hit_blocks.clear();
+    }
+    
+    void update(ECS& ecs) {
+        if (hitboxes.empty()) return;
+        
+        activate_pending(ecs);
+        find_overlaps(ecs);
+        
+        for (auto& pair : candidate_pairs) {
+            on_hit(ecs, hitboxes[pair.first], pair.second);
+        }
+        
+        for (auto& hitbox : hitboxes) {
+            if (hitbox.active) {
+                hitbox.duration -= 1;
+                if (hitbox.duration <= 0) {
+                    hitbox.remove = true;
+                }
+            }
+            if (hitbox.remove) hitbox.units_hit.release(hit_blocks);
+        }
+        hitboxes.erase(std::remove_if(hitboxes.begin(), hitboxes.end(),
+                                      [](const Hitbox& h) { return h.remove; }),
+                       hitboxes.end());
+    }
+    
+    void render(Rectangle view) {
+        if (!draw_debug) return;
+        for (auto& hitbox : hitboxes) {
+            if (!hitbox.active || !CheckCollisionRecs(hitbox.rect, view)) continue;
+            DrawRectangleRec(hitbox.rect, {255, 0, 0, 100});  // Semi-transparent red
+            DrawRectangleLinesEx(hitbox.rect, 2, {255, 0, 0, 255});
+        }
+    }
+    
+private:
+    void activate_pending(ECS& ecs) {
+        for (auto& hitbox : hitboxes) {
+            if (hitbox.active) continue;
+            if (hitbox.wait > 0) {
+                hitbox.wait -= 1;
+                continue;
+            }
+            
+            auto* pos = ecs.get_component<PositionComponent>(hitbox.owner);
+            if (!pos) {
+                hitbox.remove = true;  // Owner is gone
+                continue;
+            }
+            
+            // Bottom-aligned in front of the owner, like the backup system
+            hitbox.rect = {0, pos->rect.y + pos->rect.height - hitbox.height, hitbox.width, hitbox.height};
+            hitbox.rect.x = pos->facing_right ? pos->rect.x + pos->rect.width : pos->rect.x - hitbox.width;
+            hitbox.active = true;
+        }
+    }
+    
+    // Sort-and-sweep along X: only boxes whose X intervals overlap are ever compared
+    void find_overlaps(ECS& ecs) {
+        boxes.clear();
+        candidate_pairs.clear();
+        
+        for (int i = 0; i < (int)hitboxes.size(); i++) {
+            const Hitbox& h = hitboxes[i];
+            if (!h.active || h.remove) continue;
+            boxes.push_back({h.rect.x, h.rect.x + h.rect.width, h.rect.y, h.rect.y + h.rect.height,
+                             i, h.side, true});
+        }
+        if (boxes.empty()) return;
+        
+        auto units = ecs.get_entities_with<PositionComponent, HealthComponent, AIComponent>();
+        for (Entity unit : units) {
+            if (ecs.get_component<HealthComponent>(unit)->is_dead) continue;
+            const Rectangle& r = ecs.get_component<PositionComponent>(unit)->rect;
+            boxes.push_back({r.x, r.x + r.width, r.y, r.y + r.height,
+                             unit, ecs.get_component<AIComponent>(unit)->side, false});
+        }
+        
+        std::sort(boxes.begin(), boxes.end(),
+                  [](const SweepBox& a, const SweepBox& b) { return a.min_x < b.min_x; });
+        
+        open_hitboxes.clear();
+        open_hurtboxes.clear();
+        
+        auto overlaps_y = [](const SweepBox& a, const SweepBox& b) {
+            return a.min_y <= b.max_y && b.min_y <= a.max_y;
+        };
+        auto close_before = [this](std::vector<int>& open, float x) {
+            open.erase(std::remove_if(open.begin(), open.end(),
+                                      [&](int b) { return boxes[b].max_x < x; }),
+                       open.end());
+        };
+        
+        for (int b = 0; b < (int)boxes.size(); b++) {
+            const SweepBox& box = boxes[b];
+            close_before(open_hitboxes, box.min_x);
+            close_before(open_hurtboxes, box.min_x);
+            
+            if (box.is_hitbox) {
+                for (int other : open_hurtboxes) {
+                    try_pair(box, boxes[other], overlaps_y);
+                }
+                open_hitboxes.push_back(b);
+            } else {
+                for (int other : open_hitboxes) {
+                    try_pair(boxes[other], box, overlaps_y);
+                }
+                open_hurtboxes.push_back(b);
+            }
+        }
+    }
+    
+    template<typename OverlapFn>
+    void try_pair(const SweepBox& hit, const SweepBox& hurt, OverlapFn overlaps_y) {
+        if (hit.side == hurt.side || !overlaps_y(hit, hurt)) return;
+        if (hitboxes[hit.index].units_hit.contains(hurt.index, hit_blocks)) return;
+        candidate_pairs.push_back({hit.index, hurt.index});
+    }
+    
+    void on_hit(ECS& ecs, Hitbox& hitbox, Entity target) {
+        auto* target_health = ecs.get_component<HealthComponent>(target);
+        if (!target_health || target_health->is_dead) return;
+        
+        hitbox.units_hit.insert(target, hit_blocks);
+        target_health->take_damage(hitbox.damage);
+        ecs.mark_changed(target_health);
+        
+        // Knock the target away from the attacker
+        auto* target_mov = ecs.get_component<MovementComponent>(target);
+        auto* target_pos = ecs.get_component<PositionComponent>(target);
+        auto* owner_pos = ecs.get_component<PositionComponent>(hitbox.owner);
+        if (target_mov && target_pos && owner_pos) {
+            target_mov->knockback_dx += (owner_pos->rect.x < target_pos->rect.x) ? hitbox.knockback : -hitbox.knockback;
+        }
+        
+        if (hitbox.heal_on_hit > 0) {
+            auto* owner_health = ecs.get_component<HealthComponent>(hitbox.owner);
+            if (owner_health) {
+                owner_health->heal(hitbox.heal_on_hit);
+                ecs.mark_changed(owner_health);
+            }
+        }
+        
+        if (hitbox.effect && effects) {
+            effects->apply(ecs, target, *hitbox.effect);
+        }
+    }
+};
+
+// ==================== UNIT PREFABS ====================
+
+// Compact unit template parsed from data/temp_data/unit_prefabs.txt
+struct UnitPrefab {
+    std::string name;
+    int side;
+    float width, height;
+    int hp;
+    float speed;
+    int cooldown, damage;
+    float range;
+    int duration, swing_frame;
+    const AnimationSet* animations;
+    int loadout = -1;  // AbilityLibrary loadout index, -1 for units without skills
+};
+
+class PrefabLibrary {
+private:
+    std::vector<std::unique_ptr<UnitPrefab>> prefabs;
+    std::unordered_map<std::string, UnitPrefab*> by_name;
+    
+    struct PendingSet {
+        std::unique_ptr<AnimationSet> set;
+        std::string name;
+    };
+    
+    struct PendingClip {
+        size_t set_index;
+        int slot;
+        std::string path;
+        int frames, frame_size;
+        bool repeat;
+    };
+    
+    static int clip_slot(const std::string& slot) {
+        if (slot == "idle") return CLIP_IDLE;
+        if (slot == "move") return CLIP_MOVE;
+        if (slot == "attack") return CLIP_ATTACK;
+        if (slot == "hit") return CLIP_HIT;
+        if (slot == "death") return CLIP_DEATH;
+        return -1;
+    }
+    
+public:
+    static std::vector<std::string> split_csv(const std::string& line) {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+    
+    // Parses every prefab in the file and builds their shared animation sets
+    bool load(const std::string& filename, AnimationLibrary& animations) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cout << "Failed to open prefab file: " << filename << std::endl;
+            return false;
+        }
+        
+        std::vector<PendingSet> pending;
+        std::unordered_map<std::string, size_t> pending_index;
+        std::vector<PendingClip> clips;
+        
+        std::string line;
+        int line_number = 0;
+        while (std::getline(file, line)) {
+            line_number++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            
+            std::vector<std::string> f = split_csv(line);
+            try {
+                if (f[0] == "unit" && f.size() >= 14) {
+                    auto prefab = std::make_unique<UnitPrefab>();
+                    prefab->name = f[1];
+                    prefab->side = std::stoi(f[2]);
+                    prefab->width = std::stof(f[3]);
+                    prefab->height = std::stof(f[4]);
+                    prefab->hp = std::stoi(f[5]);
+                    prefab->speed = std::stof(f[6]);
+                    prefab->cooldown = std::stoi(f[7]);
+                    prefab->damage = std::stoi(f[8]);
+                    prefab->range = std::stof(f[9]);
+                    prefab->duration = std::stoi(f[10]);
+                    prefab->swing_frame = std::stoi(f[11]);
+                    prefab->animations = nullptr;
+                    
+                    auto set = std::make_unique<AnimationSet>();
+                    set->offsetx = std::stof(f[12]) * set->scale;
+                    set->offsety = std::stof(f[13]) * set->scale;
+                    pending_index[prefab->name] = pending.size();
+                    pending.push_back({std::move(set), prefab->name});
+                    
+                    by_name[prefab->name] = prefab.get();
+                    prefabs.push_back(std::move(prefab));
+                } else if (f[0] == "clip" && f.size() >= 7) {
+                    auto it = pending_index.find(f[1]);
+                    int slot = clip_slot(f[2]);
+                    if (it == pending_index.end() || slot < 0) {
+                        std::cout << filename << ":" << line_number << ": clip for unknown unit or slot" << std::endl;
+                        continue;
+                    }
+                    clips.push_back({it->second, slot, f[3], std::stoi(f[4]), std::stoi(f[5]), f[6] != "0"});
+                } else {
+                    std::cout << filename << ":" << line_number << ": unrecognised line" << std::endl;
+                }
+            } catch (const std::exception&) {
+                std::cout << filename << ":" << line_number << ": invalid number" << std::endl;
+            }
+        }
+        
+        // Every sprite is known now, so decode them together before building clips
+        std::vector<std::string> manifest;
+        manifest.reserve(clips.size());
+        for (const PendingClip& c : clips) {
+            manifest.push_back(c.path);
+        }
+        animations.preload(manifest);
+        
+        for (const PendingClip& c : clips) {
+            pending[c.set_index].set->clips[c.slot] = animations.make_clip(c.path, c.frames, c.frame_size, c.repeat);
+        }
+        
+        for (auto& p : pending) {
+            by_name[p.name]->animations = animations.define(p.name, std::move(p.set));
+        }
+        
+        std::cout << "Loaded " << prefabs.size() << " unit prefabs from " << filename << std::endl;
+        return !prefabs.empty();
+    }
+    
+    const UnitPrefab* find(const std::string& name) const {
+        auto it = by_name.find(name);
+        return it != by_name.end() ? it->second : nullptr;
+    }
+    
+    bool set_loadout(const std::string& name, int loadout) {
+        auto it = by_name.find(name);
+        if (it == by_name.end()) return false;
+        it->second->loadout = loadout;
+        return true;
+    }
+    
+    // Every prefab on the given side, e.g. to pick a random enemy type
+    std::vector<const UnitPrefab*> on_side(int side) const {
+        std::vector<const UnitPrefab*> result;
+        for (auto& prefab : prefabs) {
+            if (prefab->side == side) result.push_back(prefab.get());
+        }
+        return result;
+    }
+};
+
+// ==================== ABILITIES ====================
+
+// Q/W/E/R skills. Definitions are shared data parsed from data/temp_data/abilities.txt,
+// so adding abilities doesn't grow units: each unit only owns ABILITY_SLOTS
+// (ability id, cooldown) pairs in the AbilitySystem's flat arrays.
+const int ABILITY_SLOTS = 4;
+const uint16_t NO_ABILITY = 0xFFFF;
+const int ACTION_BAR_ICON_SIZE = 100;
+static const char* const ABILITY_KEYS[ABILITY_SLOTS] = {"Q", "W", "E", "R"};
+
+struct AbilityDef {
+    std::string name;
+    std::string icon_path;
+    int cooldown;          // Frames before it can be cast again
+    int duration;          // Frames the caster can't move or auto-attack
+    int hit_wait;          // Hitbox timing, as in HitboxSystem::spawn
+    int hit_duration;
+    float width, height;
+    int damage;
+    float knockback;
+    int heal_on_hit;
+    HitEffect effect;      // Applied to every unit the hitbox hits
+    Texture2D icon = {};   // Scaled to ACTION_BAR_ICON_SIZE, owned by the AnimationLibrary
+};
+
+// Ability ids per slot for one unit type
+struct AbilityLoadout {
+    uint16_t slots[ABILITY_SLOTS];
+};
+
+class AbilityLibrary {
+private:
+    std::vector<AbilityDef> defs;  // Not resized after load; hitboxes point at their effects
+    std::vector<AbilityLoadout> loadouts;
+    
+    static bool parse_effect(const std::string& kind, HitEffect& effect) {
+        if (kind == "none") effect.type = EFFECT_TYPE_COUNT;
+        else if (kind == "poison") effect.type = EFFECT_DAMAGE_OVER_TIME;
+        else if (kind == "stun") effect.type = EFFECT_STUN;
+        else if (kind == "slow") {
+            effect.type = EFFECT_STAT_MODIFIER;
+            effect.stat = STAT_SPEED_PERCENT;
+        } else if (kind == "weaken") {
+            effect.type = EFFECT_STAT_MODIFIER;
+            effect.stat = STAT_DAMAGE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+public:
+    // Parses every ability and hands each unit loadout to its prefab
+    bool load(const std::string& filename, PrefabLibrary& prefabs) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cout << "Failed to open ability file: " << filename << std::endl;
+            return false;
+        }
+        
+        std::string line;
+        int line_number = 0;
+        while (std::getline(file, line)) {
+            line_number++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            
+            std::vector<std::string> f = PrefabLibrary::split_csv(line);
+            try {
+                if (f[0] == "ability" && f.size() >= 16) {
+                    AbilityDef def;
+                    def.name = f[1];
+                    def.icon_path = f[2];
+                    def.cooldown = std::stoi(f[3]);
+                    def.duration = std::stoi(f[4]);
+                    def.hit_wait = std::stoi(f[5]);
+                    def.hit_duration = std::stoi(f[6]);
+                    def.width = std::stof(f[7]);
+                    def.height = std::stof(f[8]);
+                    def.damage = std::stoi(f[9]);
+                    def.knockback = std::stof(f[10]);
+                    def.heal_on_hit = std::stoi(f[11]);
+                    if (!parse_effect(f[12], def.effect)) {
+                        std::cout << filename << ":" << line_number << ": unknown effect " << f[12] << std::endl;
+                        continue;
+                    }
+                    def.effect.magnitude = std::stoi(f[13]);
+                    def.effect.duration = std::stoi(f[14]);
+                    def.effect.period = std::stoi(f[15]);
+                    defs.push_back(def);
+                } else if (f[0] == "loadout" && f.size() >= 2 + ABILITY_SLOTS) {
+                    AbilityLoadout loadout;
+                    for (int slot = 0; slot < ABILITY_SLOTS; slot++) {
+                        int id = find(f[2 + slot]);
+                        if (id < 0 && f[2 + slot] != "-") {
+                            std::cout << filename << ":" << line_number << ": unknown ability " << f[2 + slot] << std::endl;
+                        }
+                        loadout.slots[slot] = id < 0 ? NO_ABILITY : (uint16_t)id;
+                    }
+                    if (!prefabs.set_loadout(f[1], (int)loadouts.size())) {
+                        std::cout << filename << ":" << line_number << ": loadout for unknown unit" << std::endl;
+                        continue;
+                    }
+                    loadouts.push_back(loadout);
+                } else {
+                    std::cout << filename << ":" << line_number << ": unrecognised line" << std::endl;
+                }
+            } catch (const std::exception&) {
+                std::cout << filename << ":" << line_number << ": invalid number" << std::endl;
+            }
+        }
+        
+        std::cout << "Loaded " << defs.size() << " abilities and " << loadouts.size()
+                  << " loadouts from " << filename << std::endl;
+        return !defs.empty();
+    }
+    
+    void load_icons(AnimationLibrary& animations) {
+        for (AbilityDef& def : defs) {
+            def.icon = animations.get_icon(def.icon_path, ACTION_BAR_ICON_SIZE);
+        }
+    }
+    
+    // Load-time lookup by name, -1 if there is no such ability
+    int find(const std::string& name) const {
+        for (size_t i = 0; i < defs.size(); i++) {
+            if (defs[i].name == name) return (int)i;
+        }
+        return -1;
+    }
+    
+    const AbilityDef& get(uint16_t id) const { return defs[id]; }
+    const AbilityLoadout& loadout(int index) const { return loadouts[index]; }
+};
+
+// Slot arrays count towards the per-unit budget alongside the ECS tables
+struct AbilitySlotMemory { static constexpr const char* name = "ecs/ability_slots"; };
+
+class AbilitySystem {
+private:
+    template<typename T>
+    using SlotArray = std::vector<T, TrackingAllocator<T, AbilitySlotMemory>>;
+    
+    // Unit block b owns slots [b * ABILITY_SLOTS, (b + 1) * ABILITY_SLOTS)
+    SlotArray<uint16_t> slot_ability;
+    SlotArray<int32_t> slot_cooldown;   // Frames until the slot is ready, 0 when ready
+    SlotArray<Entity> block_owner;      // -1 for a free block
+    std::vector<uint32_t> free_blocks;
+    
+    // Input only queues casts; they are validated and started at the top of update
+    struct CastCommand {
+        Entity caster;
+        int slot;
+    };
+    std::vector<CastCommand> commands;
+    
+    struct ActiveCast {
+        Entity caster;
+        int remaining;  // Frames until the caster is released
+    };
+    std::vector<ActiveCast> casts;
+    
+    int sweep_timer = 0;
+    static const int SWEEP_INTERVAL = 60;  // Frames between removed-unit cleanups
+    
+    static const int ICON_SPACING = 10;
+    static const int BAR_MARGIN = 10;
+    
+public:
+    bool verbose = true;  // Log each cast; off for stress runs
+    
+    // Gives a unit its slot block; call once per unit, right after spawning it
+    void grant(ECS& ecs, Entity entity, const AbilityLoadout& loadout) {
+        uint32_t block;
+        if (!free_blocks.empty()) {
+            block = free_blocks.back();
+            free_blocks.pop_back();
+        } else {
+            block = (uint32_t)block_owner.size();
+            block_owner.push_back(-1);
+            slot_ability.resize(slot_ability.size() + ABILITY_SLOTS, NO_ABILITY);
+            slot_cooldown.resize(slot_cooldown.size() + ABILITY_SLOTS, 0);
+        }
+        
+        block_owner[block] = entity;
+        for (int slot = 0; slot < ABILITY_SLOTS; slot++) {
+            slot_ability[block * ABILITY_SLOTS + slot] = loadout.slots[slot];
+            slot_cooldown[block * ABILITY_SLOTS + slot] = 0;
+        }
+        ecs.add_component<AbilityComponent>(entity, block);
+    }
+    
+    void queue_cast(Entity caster, int slot) {
+        commands.push_back({caster, slot});
+    }
+    
+    // Every unit with abilities tries the same slot (stress test)
+    void queue_cast_all(int slot) {
+        for (Entity owner : block_owner) {
+            if (owner >= 0) commands.push_back({owner, slot});
+        }
+    }
+    
+    size_t active_casts() const { return casts.size(); }
+    
+    void clear() {
+        slot_ability.clear();
+        slot_cooldown.clear();
+        block_owner.clear();
+        free_blocks.clear();
+        commands.clear();
+        casts.clear();
+    }
+    
+    void update(ECS& ecs, const AbilityLibrary& library, HitboxSystem& hitboxes, uint32_t now) {
+        tick_cooldowns();
+        
+        for (const CastCommand& command : commands) {
+            start_cast(ecs, library, hitboxes, command, now);
+        }
+        commands.clear();
+        
+        advance_casts(ecs);
+        
+        if (++sweep_timer >= SWEEP_INTERVAL) {
+            sweep_timer = 0;
+            sweep_removed_owners(ecs);
+        }
+    }
+    
+    // Top-left action bar for one unit: white-bordered icons, with a gray overlay
+    // from the top covering the fraction of the cooldown still remaining
+    void render_action_bar(ECS& ecs, const AbilityLibrary& library, Entity entity) {
+        auto* abilities = ecs.get_component<AbilityComponent>(entity);
+        if (!abilities) return;
+        
+        for (int slot = 0; slot < ABILITY_SLOTS; slot++) {
+            size_t index = abilities->block * ABILITY_SLOTS + slot;
+            Rectangle box = {(float)(BAR_MARGIN + slot * (ACTION_BAR_ICON_SIZE + ICON_SPACING)), (float)BAR_MARGIN,
+                             (float)ACTION_BAR_ICON_SIZE, (float)ACTION_BAR_ICON_SIZE};
+            DrawRectangleRec(box, {0, 0, 0, 160});
+            
+            if (slot_ability[index] != NO_ABILITY) {
+                const AbilityDef& def = library.get(slot_ability[index]);
+                if (def.icon.id != 0) {
+                    Rectangle source = {0, 0, (float)def.icon.width, (float)def.icon.height};
+                    DrawTexturePro(def.icon, source, box, {0, 0}, 0.0f, WHITE);
+                }
+                if (slot_cooldown[index] > 0 && def.cooldown > 0) {
+                    float remaining = (float)slot_cooldown[index] / def.cooldown;
+                    DrawRectangleRec({box.x, box.y, box.width, box.height * remaining}, {128, 128, 128, 180});
+                }
+            }
+            
+            DrawRectangleLinesEx(box, 2, WHITE);
+            DrawText(ABILITY_KEYS[slot], (int)box.x + 6, (int)box.y + 4, 20, WHITE);
+        }
+    }
+    
+private:
+    // Every slot of every unit in one flat, branch-free pass the compiler can vectorize
+    void tick_cooldowns() {
+        int32_t* cooldown = slot_cooldown.data();
+        size_t count = slot_cooldown.size();
+        for (size_t i = 0; i < count; i++) {
+            cooldown[i] = std::max(cooldown[i] - 1, 0);
+        }
+    }
+    
+    // Skills activate instantly: they cancel any auto-attack and root the caster
+    // for the ability's duration (docs/game-vision.md, Skill System)
+    bool start_cast(ECS& ecs, const AbilityLibrary& library, HitboxSystem& hitboxes, const CastCommand& command,
+                    uint32_t now) {
+        if (command.slot < 0 || command.slot >= ABILITY_SLOTS) return false;
+        
+        auto* abilities = ecs.get_component<AbilityComponent>(command.caster);
+        auto* ai = ecs.get_component<AIComponent>(command.caster);
+        auto* health = ecs.get_component<HealthComponent>(command.caster);
+        if (!abilities || !ai || !health || health->is_dead || ai->stunned || ai->casting) return false;
+        
+        size_t index = abilities->block * ABILITY_SLOTS + command.slot;
+        if (slot_ability[index] == NO_ABILITY || slot_cooldown[index] > 0) return false;
+        
+        const AbilityDef& def = library.get(slot_ability[index]);
+        slot_cooldown[index] = def.cooldown;
+        
+        auto* attack = ecs.get_component<AttackComponent>(command.caster);
+        if (attack && attack->is_attacking) {
+            attack->cancel_attack();
+        }
+        if (auto* mov = ecs.get_component<MovementComponent>(command.caster)) {
+            mov->move_dx = 0;
+            mov->move_dy = 0;
+        }
+        if (auto* anim = ecs.get_component<AnimationComponent>(command.caster)) {
+            anim->play(CLIP_ATTACK, now);
+        }
+        
+        // Turn towards the current target so the hitbox lands on it
+        auto* pos = ecs.get_component<PositionComponent>(command.caster);
+        auto* target_pos = ai->has_target ? ecs.get_component<PositionComponent>(ai->target_entity) : nullptr;
+        if (pos && target_pos && pos->face(target_pos->get_center_bottom().x > pos->get_center_bottom().x)) {
+            ecs.mark_changed(pos);
+        }
+        
+        ai->casting = true;
+        hitboxes.spawn(command.caster, ai->side, def.width, def.height, def.damage, def.hit_wait,
+                       def.hit_duration, def.heal_on_hit, def.knockback,
+                       def.effect.enabled() ? &def.effect : nullptr);
+        casts.push_back({command.caster, std::max(def.duration, 1)});
+        
+        if (verbose) {
+            std::cout << ai->type_name << " casts " << def.name << " (" << ABILITY_KEYS[command.slot] << ")" << std::endl;
+        }
+        return true;
+    }
+    
+    void advance_casts(ECS& ecs) {
+        for (size_t i = 0; i < casts.size();) {
+            auto* ai = ecs.get_component<AIComponent>(casts[i].caster);
+            auto* health = ecs.get_component<HealthComponent>(casts[i].caster);
+            bool finished = --casts[i].remaining <= 0 || !ai || !health || health->is_dead;
+            
+            if (finished) {
+                if (ai) ai->casting = false;
+                casts[i] = casts.back();
+                casts.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+    
+    // Corpses are removed by HealthSystem; return their blocks to the free list
+    void sweep_removed_owners(ECS& ecs) {
+        for (uint32_t block = 0; block < (uint32_t)block_owner.size(); block++) {
+            Entity owner = block_owner[block];
+            if (owner < 0 || ecs.get_component<AbilityComponent>(owner)) continue;
+            
+            block_owner[block] = -1;
+            for (int slot = 0; slot < ABILITY_SLOTS; slot++) {
+                slot_ability[block * ABILITY_SLOTS + slot] = NO_ABILITY;
+                slot_cooldown[block * ABILITY_SLOTS + slot] = 0;
+            }
+            free_blocks.push_back(block);
+        }
+    }
+};
+
+// ==================== UNIT COMMANDS ====================
+
+// Player orders for a whole selection. A group command is expanded into one order
+// per unit in a single pass and queued; the batch is applied at the top of the next
+// update, before movement. Holding the right mouse button re-issues the same command
+// every frame, so a command identical to the one issued on the previous tick is dropped.
+
+enum UnitOrderKind : uint8_t {
+    ORDER_MOVE,
+    ORDER_ATTACK
+};
+
+struct UnitOrder {
+    Entity unit;
+    UnitOrderKind kind;
+    Vector2 point;    // ORDER_MOVE: this unit's formation slot (center-bottom)
+    Entity target;    // ORDER_ATTACK
+};
+
+class CommandSystem {
+private:
+    static constexpr float FORMATION_SPACING = 90.0f;  // Slot pitch; prefab units are 80 wide
+    static constexpr float COALESCE_DISTANCE = 2.0f;   // Move points closer than this are the same command
+    
+    std::vector<UnitOrder> orders;
+    
+    // The last group command, for coalescing repeats
+    std::vector<Entity> last_units;
+    UnitOrderKind last_kind = ORDER_MOVE;
+    Vector2 last_point = {0, 0};
+    Entity last_target = -1;
+    uint64_t last_tick = 0;
+    bool has_last = false;
+    bool continued = false;   // Same units and kind as the previous tick, new destination (dragging)
+    
+public:
+    bool verbose = true;   // Log each group command that isn't coalesced
+    int coalesced = 0;     // Repeats dropped since the last clear
+    
+    // Square-ish grid of slots centered on point, the last row centered too.
+    // Slots are filled row by row, so a selection in draw order (back to front)
+    // keeps its rows in the same order and units don't cross paths.
+    void move_group(const int* units, int count, Vector2 point, uint64_t tick) {
+        if (count <= 0 || repeats_last(ORDER_MOVE, units, count, point, -1, tick)) return;
+        
+        int cols = (int)std::ceil(std::sqrt((float)count));
+        int rows = (count + cols - 1) / cols;
+        float top = point.y - (rows - 1) * FORMATION_SPACING / 2;
+        for (int i = 0; i < count; i++) {
+            int row = i / cols;
+            int in_row = (row == rows - 1) ? count - row * cols : cols;
+            float left = point.x - (in_row - 1) * FORMATION_SPACING / 2;
+            orders.push_back({units[i], ORDER_MOVE,
+                              {left + (i % cols) * FORMATION_SPACING, top + row * FORMATION_SPACING}, -1});
+        }
+        
+        if (verbose && !continued) {
+            std::cout << "Group move: " << count << " units to (" << point.x << ", " << point.y << ")" << std::endl;
+        }
+    }
+    
+    void attack_group(const int* units, int count, Entity target, uint64_t tick) {
+        if (count <= 0 || repeats_last(ORDER_ATTACK, units, count, {0, 0}, target, tick)) return;
+        
+        for (int i = 0; i < count; i++) {
+            orders.push_back({units[i], ORDER_ATTACK, {0, 0}, target});
+        }
+        
+        if (verbose && !continued) {
+            std::cout << "Group attack: " << count << " units on entity " << target << std::endl;
+        }
+    }
+    
+    // Applies the queued batch; dead or removed units are skipped
+    void update(ECS& ecs) {
+        for (const UnitOrder& order : orders) {
+            auto* ai = ecs.get_component<AIComponent>(order.unit);
+            auto* health = ecs.get_component<HealthComponent>(order.unit);
+            if (!ai || (health && health->is_dead)) continue;
+            
+            if (order.kind == ORDER_MOVE) {
+                ai->has_target = false;
+                ai->target_entity = -1;
+                ai->has_move_target = true;
+                ai->move_target = order.point;
+            } else {
+                ai->target_entity = order.target;
+                ai->has_target = true;
+            }
+        }
+        orders.clear();
+    }
+    
+    size_t pending() const { return orders.size(); }
+    
+    void clear() {
+        orders.clear();
+        has_last = false;
+        coalesced = 0;
+    }
+    
+private:
+    // True if this is the previous tick's command again (same units, kind and
+    // destination); otherwise remembers it as the new last command
+    bool repeats_last(UnitOrderKind kind, const int* units, int count, Vector2 point, Entity target, uint64_t tick) {
+        continued = has_last && tick <= last_tick + 1 && kind == last_kind &&
+                    (size_t)count == last_units.size() && std::equal(units, units + count, last_units.begin());
+        bool same = continued &&
+                    (kind == ORDER_MOVE ? std::fabs(point.x - last_point.x) < COALESCE_DISTANCE &&
+                                          std::fabs(point.y - last_point.y) < COALESCE_DISTANCE
+                                        : target == last_target);
+        last_tick = tick;
+        if (same) {
+            coalesced++;
+            return true;
+        }
+        
+        has_last = true;
+        last_kind = kind;
+        last_point = point;
+        last_target = target;
+        last_units.assign(units, units + count);
+        return false;
+    }
+};
+
+// ==================== STRESS TEST ====================
+
+// Milliseconds spent in each system during one frame
+struct SystemTimings {
+    double timers_ms = 0, movement_ms = 0, abilities_ms = 0, attack_ms = 0, hitbox_ms = 0, effects_ms = 0;
+    double animation_ms = 0, health_ms = 0, render_ms = 0;
+    
+    double total_ms() const {
+        return timers_ms + movement_ms + abilities_ms + attack_ms + hitbox_ms + effects_ms + animation_ms
+             + health_ms + render_ms;
+    }
+    
+    void add(const SystemTimings& other) {
+        timers_ms += other.timers_ms;
+        movement_ms += other.movement_ms;
+        abilities_ms += other.abilities_ms;
+        attack_ms += other.attack_ms;
+        hitbox_ms += other.hitbox_ms;
+        effects_ms += other.effects_ms;
+        animation_ms += other.animation_ms;
+        health_ms += other.health_ms;
+        render_ms += other.render_ms;
+    }
+    
+    void scale(double factor) {
+        timers_ms *= factor;
+        movement_ms *= factor;
+        abilities_ms *= factor;
+        attack_ms *= factor;
+        hitbox_ms *= factor;
+        effects_ms *= factor;
+        animation_ms *= factor;
+        health_ms *= factor;
+        render_ms *= factor;
+    }
+};
+
+// Resident set size of the process, 0 where it can't be read
+inline long current_rss_kb() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long pages_total = 0, pages_resident = 0;
+    if (statm >> pages_total >> pages_resident) {
+        return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+#endif
+    return 0;
+}
+
+// Ramps unit counts step by step and records how every system scales
+class StressTest {
+public:
+    struct StepResult {
+        int units_per_side;
+        int total_units;
+        double avg_frame_ms;     // Wall time between consecutive frames (drawing and swap included)
+        double max_frame_ms;
+        double avg_systems_ms;   // Sum of the per-system timers
+        double max_systems_ms;
+        SystemTimings avg_systems;
+        long rss_kb;
+        double unit_bytes;  // Tracked component + ECS bytes per unit
+        double heap_allocs_per_frame;
+        double ai_decisions_per_frame;
+        size_t arena_peak_bytes;
+        size_t arena_overflows;
+    };
+    
+    std::vector<int> steps = {100, 500, 1000, 5000};
+    int warmup_frames = 30;
+    int measure_frames = 60;
+    
+    bool running = false;
+    bool headless = false;
+    uint64_t seed = 0;       // Battle seed, so a report can be reproduced
+    std::string report_path;
+    int step_index = 0;
+    int frame_in_step = 0;   // 0 means the step still needs its units spawned
+    std::vector<StepResult> results;
+    
+    void begin(const std::string& path, bool is_headless, uint64_t battle_seed) {
+        report_path = path;
+        headless = is_headless;
+        seed = battle_seed;
+        running = true;
+        step_index = 0;
+        frame_in_step = 0;
+        results.clear();
+        reset_accumulators();
+        last_frame = Clock::now();
+        std::cout << "Stress test started (" << (headless ? "headless" : "windowed") << ")" << std::endl;
+    }
+    
+    int current_units_per_side() const { return steps[step_index]; }
+    
+    // Records one finished frame; returns true when the whole ramp is done
+    bool record(const SystemTimings& frame, int total_units, double unit_bytes, size_t frame_allocs,
+                int ai_decisions) {
+        // Called once per game-loop frame, so the gap between calls is the real frame time
+        Clock::time_point now = Clock::now();
+        double frame_ms = std::chrono::duration<double, std::milli>(now - last_frame).count();
+        last_frame = now;
+        
+        frame_in_step++;
+        if (frame_in_step == warmup_frames) {
+            frame_arena().clear_stats();  // Measure the arena over steady-state frames only
+        }
+        if (frame_in_step > warmup_frames) {
+            double systems_ms = frame.total_ms();
+            alloc_sum += frame_allocs;
+            decision_sum += ai_decisions;
+            accumulated.add(frame);
+            frame_sum_ms += frame_ms;
+            frame_max_ms = std::max(frame_max_ms, frame_ms);
+            systems_sum_ms += systems_ms;
+            systems_max_ms = std::max(systems_max_ms, systems_ms);
+        }
+        
+        if (frame_in_step < warmup_frames + measure_frames) return false;
+        
+        StepResult result;
+        result.units_per_side = steps[step_index];
+        result.total_units = total_units;
+        result.avg_frame_ms = frame_sum_ms / measure_frames;
+        result.max_frame_ms = frame_max_ms;
+        result.avg_systems_ms = systems_sum_ms / measure_frames;
+        result.max_systems_ms = systems_max_ms;
+        result.avg_systems = accumulated;
+        result.avg_systems.scale(1.0 / measure_frames);
+        result.rss_kb = current_rss_kb();
+        result.unit_bytes = unit_bytes;
+        result.heap_allocs_per_frame = HEAP_ALLOCATIONS_COUNTED ? (double)alloc_sum / measure_frames : -1.0;
+        result.ai_decisions_per_frame = (double)decision_sum / measure_frames;
+        result.arena_peak_bytes = frame_arena().peak();
+        result.arena_overflows = frame_arena().overflow_count();
+        results.push_back(result);
+        
+        std::cout << "Stress step " << result.units_per_side << "/side: avg " << result.avg_frame_ms
+                  << " ms, max " << result.max_frame_ms << " ms (systems avg " << result.avg_systems_ms
+                  << " ms), ";
+        if (HEAP_ALLOCATIONS_COUNTED) {
+            std::cout << result.heap_allocs_per_frame << " heap allocs/frame" << std::endl;
+        } else {
+            std::cout << "heap allocs not counted" << std::endl;
+        }
+        if (result.arena_overflows > 0) {
+            std::cout << "WARNING: frame arena overflowed " << result.arena_overflows
+                      << " times, peak " << result.arena_peak_bytes << " of " << frame_arena().size() << " bytes" << std::endl;
+        }
+        
+        reset_accumulators();
+        frame_in_step = 0;
+        step_index++;
+        if (step_index >= (int)steps.size()) {
+            running = false;
+            write_report();
+            return true;
+        }
+        return false;
+    }
+    
+    bool write_report() const {
+        std::ofstream file(report_path);
+        if (!file.is_open()) {
+            std::cout << "Failed to write stress report: " << report_path << std::endl;
+            return false;
+        }
+        
+        file << "# Stress test (" << (headless ? "headless" : "windowed") << "), "
+             << warmup_frames << " warmup + " << measure_frames << " measured frames per step, seed "
+             << seed << std::endl;
+        if (!HEAP_ALLOCATIONS_COUNTED) {
+            file << "# heap_allocs_per_frame is -1: rebuild with -DSEARCHING_COUNT_ALLOCATIONS=ON to count them" << std::endl;
+        }
+        file << "units_per_side,total_units,avg_frame_ms,max_frame_ms,avg_systems_ms,max_systems_ms,timers_ms,movement_ms,abilities_ms,attack_ms,"
+             << "hitbox_ms,effects_ms,animation_ms,health_ms,render_ms,rss_kb,unit_bytes,"
+             << "heap_allocs_per_frame,ai_decisions_per_frame,arena_peak_bytes,arena_overflows" << std::endl;
+        for (const StepResult& r : results) {
+            file << r.units_per_side << "," << r.total_units << ","
+                 << r.avg_frame_ms << "," << r.max_frame_ms << ","
+                 << r.avg_systems_ms << "," << r.max_systems_ms << ","
+                 << r.avg_systems.timers_ms << "," << r.avg_systems.movement_ms << ","
+                 << r.avg_systems.abilities_ms << ","
+                 << r.avg_systems.attack_ms << ","
+                 << r.avg_systems.hitbox_ms << "," << r.avg_systems.effects_ms << ","
+                 << r.avg_systems.animation_ms << ","
+                 << r.avg_systems.health_ms << "," << r.avg_systems.render_ms << ","
+                 << r.rss_kb << "," << r.unit_bytes << ","
+                 << r.heap_allocs_per_frame << "," << r.ai_decisions_per_frame << "," << r.arena_peak_bytes << "," << r.arena_overflows << std::endl;
+        }
+        std::cout << "Stress report written to " << report_path << std::endl;
+        return true;
+    }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    Clock::time_point last_frame;
+    SystemTimings accumulated;
+    double frame_sum_ms = 0;
+    double frame_max_ms = 0;
+    double systems_sum_ms = 0;
+    double systems_max_ms = 0;
+    size_t alloc_sum = 0;
+    long decision_sum = 0;
+    
+    void reset_accumulators() {
+        accumulated = SystemTimings();
+        frame_sum_ms = 0;
+        frame_max_ms = 0;
+        systems_sum_ms = 0;
+        systems_max_ms = 0;
+        alloc_sum = 0;
+        decision_sum = 0;
+    }
+};
+
+// ==================== CAMERA ====================
+
+// View over an arena bigger than the window: arrow keys or middle-drag pan, the wheel
+// zooms around the cursor. At the default camera world and screen coordinates match.
+struct BattleCamera {
+    Camera2D camera = {{0, 0}, {0, 0}, 0.0f, 1.0f};
+    float pan_speed = 12.0f;   // Screen pixels per frame
+    float min_zoom = 0.25f;
+    float max_zoom = 3.0f;
+    
+    void handle_input() {
+        Vector2 pan = {0, 0};
+        if (IsKeyDown(KEY_LEFT)) pan.x -= pan_speed;
+        if (IsKeyDown(KEY_RIGHT)) pan.x += pan_speed;
+        if (IsKeyDown(KEY_UP)) pan.y -= pan_speed;
+        if (IsKeyDown(KEY_DOWN)) pan.y += pan_speed;
+        if (IsMouseButtonDown(MOUSE_MIDDLE_BUTTON)) {
+            Vector2 drag = GetMouseDelta();
+            pan.x -= drag.x;
+            pan.y -= drag.y;
+        }
+        camera.target.x += pan.x / camera.zoom;
+        camera.target.y += pan.y / camera.zoom;
+        
+        float wheel = GetMouseWheelMove();
+        if (wheel != 0) {
+            // Keep the world point under the cursor fixed while zooming
+            Vector2 mouse = GetMousePosition();
+            camera.target = GetScreenToWorld2D(mouse, camera);
+            camera.offset = mouse;
+            camera.zoom = std::clamp(camera.zoom * (1.0f + 0.1f * wheel), min_zoom, max_zoom);
+        }
+    }
+    
+    Vector2 screen_to_world(Vector2 point) const {
+        return GetScreenToWorld2D(point, camera);
+    }
+    
+    // World-space area the screen shows
+    Rectangle view_rect(float screen_width, float screen_height) const {
+        Vector2 top_left = GetScreenToWorld2D({0, 0}, camera);
+        Vector2 bottom_right = GetScreenToWorld2D({screen_width, screen_height}, camera);
+        return {top_left.x, top_left.y, bottom_right.x - top_left.x, bottom_right.y - top_left.y};
+    }
+};
+
+// ==================== BATTLE SYSTEM ====================
+
+class BattleSystem {
+private:
+    AnimationLibrary animations;  // Declared before ecs so clips outlive components
+    PrefabLibrary prefabs;
+    AbilityLibrary abilities;     // Outlives the hitboxes that point at its effects
+    ECS ecs;
+    MovementSystem movement_system;
+    AnimationSystem animation_system;
+    AttackSystem attack_system;
+    HitboxSystem hitbox_system;
+    EffectSystem effect_system;
+    AbilitySystem ability_system;
+    CommandSystem command_system;
+    HealthSystem health_system;
+    
+    Entity action_bar_entity = -1;  // Unit whose skills the action bar shows
+    
+    BattleCamera camera;
+    static constexpr uint32_t RENDER_SETTLED = 1;  // render_index flag: death clip done, nothing left to animate
+    IncrementalGrid render_index;   // Drawn area of every unit, re-filed only when it moves
+    uint32_t render_read = 0;       // ECS change tick of the previous render_index sync
+    std::vector<Entity> visible;    // Units inside the camera view this frame, in draw order
+    std::vector<Entity> animating;  // Visible units still animating (not settled corpses)
+    std::vector<std::pair<float, Entity>> draw_order;  // Sort scratch for visible
+    SpatialGrid pick_grids[2];      // Hit rects of living units per side, rebuilt on the first pick of a frame
+    uint64_t pick_grid_ticks[2] = {UINT64_MAX, UINT64_MAX};
+    
+    RngService rng;              // Spawn and combat streams, seeded per battle
+    BattleTimers timers;         // Attack cooldowns and corpse removal, one tick per update
+    
+    SystemTimings last_timings;  // Timings of the most recent frame
+    StressTest stress;
+    size_t alloc_mark = 0;       // heap_allocation_count() at the previous stress frame
+    
+    using Clock = std::chrono::steady_clock;
+    
+    static double elapsed_ms(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+    
+public:
+    explicit BattleSystem(bool headless = false, uint64_t seed = 0) : rng(seed) {
+        animations.headless = headless;
+        hitbox_system.effects = &effect_system;
+        if (headless) {
+            // Headless battles run in bulk (auto-resolve, balance runs), so no per-unit logs
+            attack_system.verbose = false;
+            ability_system.verbose = false;
+            command_system.verbose = false;
+        }
+        std::cout << "Battle seed " << seed << std::endl;
+    }
+    
+    void initialize() {
+        load_assets();
+        create_test_units();
+    }
+    
+    // Cold start: parse prefabs and upload every sprite they reference
+    double load_assets(bool use_pack = true) {
+        auto start = Clock::now();
+        animations.use_pack = use_pack;
+        prefabs.load("data/temp_data/unit_prefabs.txt", animations);
+        abilities.load("data/temp_data/abilities.txt", prefabs);
+        abilities.load_icons(animations);
+        double ms = elapsed_ms(start);
+        std::cout << "Loaded " << animations.loaded_from_pack << " textures from pack, "
+                  << animations.loaded_from_png << " from PNG in " << ms << " ms" << std::endl;
+        return ms;
+    }
+    
+    void update() {
+        if (stress.running) {
+            advance_stress_test();
+        }
+        
+        auto start = Clock::now();
+        run_timers();
+        last_timings.timers_ms = elapsed_ms(start);
+        
+        // Player orders queued since the last update
+        command_system.update(ecs);
+        
+        start = Clock::now();
         movement_system.update(ecs);
-        attack_system.update(ecs);
-        animation_system.update(ecs);
-        health_system.update(ecs);
+        last_timings.movement_ms = elapsed_ms(start);
+        
+        // Before attacks, so a skill cast this frame overrides the auto-attack
+        start = Clock::now();
+        ability_system.update(ecs, abilities, hitbox_system, tick());
+        last_timings.abilities_ms = elapsed_ms(start);
+        
+        start = Clock::now();
+        attack_system.update(ecs, timers);
+        last_timings.attack_ms = elapsed_ms(start);
+        
+        start = Clock::now();
+        hitbox_system.update(ecs);
+        last_timings.hitbox_ms = elapsed_ms(start);
+        
+        start = Clock::now();
+        effect_system.update(ecs);
+        last_timings.effects_ms = elapsed_ms(start);
+        
+        start = Clock::now();
+        health_system.update(ecs, timers);
+        last_timings.health_ms = elapsed_ms(start);
+    }
+    
+    // Battle clock: one tick per update, also the time base for animation playback
+    uint32_t tick() const { return (uint32_t)timers.now(); }
+    
+    // Advances the timer wheel one tick and handles whatever expired on it
+    void run_timers() {
+        timers.advance([this](const BattleTimer& timer) {
+            if (timer.kind == TIMER_DESPAWN) {
+                ecs.remove_entity(timer.entity);
+                render_index.remove(timer.entity);
+            } else if (timer.kind == TIMER_ATTACK_READY) {
+                if (auto* attack = ecs.get_component<AttackComponent>(timer.entity)) {
+                    attack->finish_cooldown(timer.serial);
+                }
+            }
+        });
+    }
+    
+    // ===== Stress test =====
+    
+    void begin_stress_test(const std::string& report_path) {
+        stress.begin(report_path, animations.headless, rng.get_master_seed());
+        attack_system.verbose = false;
+        ability_system.verbose = false;
+        command_system.verbose = false;
+    }
+    
+    bool stress_test_running() const { return stress.running; }
+    
+    void advance_stress_test() {
+        // Heap allocations since the last call cover one whole game-loop frame
+        size_t allocs_now = heap_allocation_count();
+        size_t frame_allocs = allocs_now - alloc_mark;
+        alloc_mark = allocs_now;
+        
+        if (stress.frame_in_step == 0) {
+            populate_stress_step(stress.current_units_per_side());
+            stress.frame_in_step = 1;
+            return;
+        }
+        
+        // Every knight tries one slot per frame; casts start whenever that slot is ready
+        ability_system.queue_cast_all(stress.frame_in_step % ABILITY_SLOTS);
+        
+        // last_timings holds the previous frame, which ran with this step's units
+        if (stress.record(last_timings, (int)ecs.entity_count(), unit_bytes(), frame_allocs,
+                          attack_system.scheduler.decisions_last_frame)) {
+            attack_system.verbose = !animations.headless;
+            ability_system.verbose = !animations.headless;
+        }
     }
     
-    void spawn_skeleton() {
-        // Spawn a new skeleton at a random position
-        Entity skeleton = ecs.create_entity();
+    void populate_stress_step(int units_per_side) {
+        const UnitPrefab* knight = prefabs.find("Knight");
+        const UnitPrefab* skeleton = prefabs.find("Skeleton");
+        if (!knight || !skeleton) {
+            std::cout << "Stress test needs Knight and Skeleton prefabs" << std::endl;
+            stress.running = false;
+            return;
+        }
+        
+        ecs.clear();
+        render_index.clear();
+        hitbox_system.clear();
+        effect_system.clear();
+        ability_system.clear();
+        command_system.clear();
+        timers.clear();
+        
+        // Players on the left half, enemies on the right half of the arena
+        Xoshiro128pp& spawn_rng = rng.stream(RNG_SPAWN);
+        std::vector<Vector2> left, right;
+        left.reserve(units_per_side);
+        right.reserve(units_per_side);
+        for (int i = 0; i < units_per_side; i++) {
+            left.push_back({(float)spawn_rng.range(50, 599), (float)spawn_rng.range(150, 649)});
+            right.push_back({(float)spawn_rng.range(680, 1229), (float)spawn_rng.range(150, 649)});
+        }
+        std::vector<Entity> knights = spawn_batch(*knight, left);
+        std::vector<Entity> skeletons = spawn_batch(*skeleton, right);
+        
+        // Two effects per unit so effect ticking scales with the army
+        for (Entity unit : knights) {
+            effect_system.apply(ecs, unit, EFFECT_HEAL_OVER_TIME, 1, EFFECT_PERMANENT, 30);
+            effect_system.apply(ecs, unit, EFFECT_STAT_MODIFIER, 10, EFFECT_PERMANENT, 1, STAT_SPEED_PERCENT);
+        }
+        for (Entity unit : skeletons) {
+            effect_system.apply(ecs, unit, EFFECT_DAMAGE_OVER_TIME, 1, 600, 20);
+            effect_system.apply(ecs, unit, EFFECT_STAT_MODIFIER, 5, EFFECT_PERMANENT, 1, STAT_DAMAGE);
+        }
         
-        // Random position away from player
-        float spawn_x = 300 + (rand() % 200); // Random X between 300-500
-        float spawn_y = 400 + (rand() % 200); // Random Y between 400-600
+        std::cout << "Stress step: " << units_per_side << " units per side, "
+                  << effect_system.active_count() << " effects" << std::endl;
+    }
+    
+    // Instantiate one unit from a prefab template
+    Entity spawn(const UnitPrefab& prefab, float x, float y) {
+        // Position, Health, Movement, Attack, AI, Animation, Stats (+ Ability)
+        Entity unit = ecs.create_entity(prefab.loadout >= 0 ? 8 : 7);
+        reserve_for_units(ecs.entity_count());
         
-        ecs.add_component<PositionComponent>(skeleton, spawn_x, spawn_y, 80, 100);
-        ecs.add_component<HealthComponent>(skeleton, 50);
-        ecs.add_component<MovementComponent>(skeleton, 0.5f);
-        // Proper skeleton attack timing: 8 frames * 10 frame_duration = 80 total, swing at frame 30
-        ecs.add_component<AttackComponent>(skeleton, 90, 15, 120, 80, 30);
-        ecs.add_component<AIComponent>(skeleton, 1, "Skeleton"); // Enemy side
+        ecs.add_component<PositionComponent>(unit, x, y, prefab.width, prefab.height);
+        ecs.add_component<HealthComponent>(unit, prefab.hp);
+        ecs.add_component<MovementComponent>(unit, prefab.speed);
+        ecs.add_component<AttackComponent>(unit, prefab.cooldown, prefab.damage, prefab.range,
+                                           prefab.duration, prefab.swing_frame);
+        ecs.add_component<AIComponent>(unit, prefab.side, prefab.name);
+        ecs.add_component<AnimationComponent>(unit, prefab.animations, tick());
+        // Up front, so the first effect a unit takes doesn't add a component mid-frame
+        ecs.add_component<StatsComponent>(unit, prefab.damage, prefab.speed, prefab.hp);
+        if (prefab.loadout >= 0) {
+            ability_system.grant(ecs, unit, abilities.loadout(prefab.loadout));
+        }
+        return unit;
+    }
+    
+    // Frame-to-frame buffers are sized as units spawn, so battle frames don't grow them.
+    // A unit has at most an attack cooldown and a corpse timer pending.
+    void reserve_for_units(size_t unit_count) {
+        attack_system.reserve_units(unit_count);
+        effect_system.reserve_units(unit_count);
+        hitbox_system.reserve_units(unit_count);
+        timers.reserve(unit_count * 2);
+    }
+    
+    // Instantiate N units with storage reserved once up front
+    std::vector<Entity> spawn_batch(const UnitPrefab& prefab, const std::vector<Vector2>& positions) {
+        std::vector<Entity> spawned;
+        spawned.reserve(positions.size());
+        ecs.reserve(ecs.entity_count() + positions.size());
         
-        ecs.add_component<AnimationComponent>(skeleton);
-        auto* skeleton_anim = ecs.get_component<AnimationComponent>(skeleton);
-        skeleton_anim->set_enemy_offsets(); // Set proper enemy offsets
-        skeleton_anim->idle_anim = std::make_unique<Animation>("assets/enemies/skeleton/Idle.png", 4, 150);
-        skeleton_anim->move_anim = std::make_unique<Animation>("assets/enemies/skeleton/Walk.png", 4, 150);
-        skeleton_anim->attack_anim = std::make_unique<Animation>("assets/enemies/skeleton/Attack.png", 8, 150);
-        skeleton_anim->attack_anim->repeat = false;
-        skeleton_anim->hit_anim = std::make_unique<Animation>("assets/enemies/skeleton/Take Hit.png", 4, 150);
-        skeleton_anim->death_anim = std::make_unique<Animation>("assets/enemies/skeleton/Death.png", 4, 150);
-        skeleton_anim->death_anim->repeat = false;
-        skeleton_anim->switch_anim(skeleton_anim->idle_anim.get());
+        for (const Vector2& p : positions) {
+            spawned.push_back(spawn(prefab, p.x, p.y));
+        }
+        return spawned;
+    }
+    
+    bool spawn_named(const std::string& name, float x, float y) {
+        const UnitPrefab* prefab = prefabs.find(name);
+        if (!prefab) {
+            std::cout << "Unknown unit prefab: " << name << std::endl;
+            return false;
+        }
+        spawn(*prefab, x, y);
+        std::cout << "Spawned new " << name << " at (" << x << ", " << y << ")" << std::endl;
+        return true;
+    }
+    
+    void spawn_random_enemy() {
+        // Spawn any enemy prefab at a random position away from the player
+        std::vector<const UnitPrefab*> enemies = prefabs.on_side(1);
+        if (enemies.empty()) return;
         
-        std::cout << "Spawned new skeleton at (" << spawn_x << ", " << spawn_y << ")" << std::endl;
+        Xoshiro128pp& spawn_rng = rng.stream(RNG_SPAWN);
+        float spawn_x = (float)spawn_rng.range(300, 499); // Random X between 300-500
+        float spawn_y = (float)spawn_rng.range(400, 599); // Random Y between 400-600
+        spawn_named(enemies[spawn_rng.below((uint32_t)enemies.size())]->name, spawn_x, spawn_y);
     }
     
     void spawn_player(float x = 200, float y = 600) {
-        // Spawn a new player knight at specified position
-        Entity knight = ecs.create_entity();
-        
-        ecs.add_component<PositionComponent>(knight, x, y, 80, 100);
-        ecs.add_component<HealthComponent>(knight, 1000);
-        ecs.add_component<MovementComponent>(knight, 2.0f);
-        ecs.add_component<AttackComponent>(knight, 60, 10, 120, 30, 15);
-        ecs.add_component<AIComponent>(knight, 0, "Knight"); // Player side
-        
-        ecs.add_component<AnimationComponent>(knight);
-        auto* knight_anim = ecs.get_component<AnimationComponent>(knight);
-        knight_anim->set_player_offsets(); // Set proper player offsets
-        knight_anim->idle_anim = std::make_unique<Animation>("assets/player/Idle.png", 10);
-        knight_anim->move_anim = std::make_unique<Animation>("assets/player/Run.png", 6);
-        knight_anim->attack_anim = std::make_unique<Animation>("assets/player/Attack1.png", 4);
-        knight_anim->attack_anim->repeat = false;
-        knight_anim->hit_anim = std::make_unique<Animation>("assets/player/Get Hit.png", 3);
-        knight_anim->death_anim = std::make_unique<Animation>("assets/player/Death.png", 9);
-        knight_anim->death_anim->repeat = false;
-        knight_anim->switch_anim(knight_anim->idle_anim.get());
-        
-        std::cout << "Spawned new player knight at (" << x << ", " << y << ")" << std::endl;
+        spawn_named("Knight", x, y);
     }
     
     void spawn_skeleton_at(float x, float y) {
-        // Spawn a new skeleton at specified position
-        Entity skeleton = ecs.create_entity();
-        
-        ecs.add_component<PositionComponent>(skeleton, x, y, 80, 100);
-        ecs.add_component<HealthComponent>(skeleton, 50);
-        ecs.add_component<MovementComponent>(skeleton, 0.5f);
-        // Proper skeleton attack timing: 8 frames * 10 frame_duration = 80 total, swing at frame 30
-        ecs.add_component<AttackComponent>(skeleton, 90, 15, 120, 80, 30);
-        ecs.add_component<AIComponent>(skeleton, 1, "Skeleton"); // Enemy side
-        
-        ecs.add_component<AnimationComponent>(skeleton);
-        auto* skeleton_anim = ecs.get_component<AnimationComponent>(skeleton);
-        skeleton_anim->set_enemy_offsets(); // Set proper enemy offsets
-        skeleton_anim->idle_anim = std::make_unique<Animation>("assets/enemies/skeleton/Idle.png", 4, 150);
-        skeleton_anim->move_anim = std::make_unique<Animation>("assets/enemies/skeleton/Walk.png", 4, 150);
-        skeleton_anim->attack_anim = std::make_unique<Animation>("assets/enemies/skeleton/Attack.png", 8, 150);
-        skeleton_anim->attack_anim->repeat = false;
-        skeleton_anim->hit_anim = std::make_unique<Animation>("assets/enemies/skeleton/Take Hit.png", 4, 150);
-        skeleton_anim->death_anim = std::make_unique<Animation>("assets/enemies/skeleton/Death.png", 4, 150);
-        skeleton_anim->death_anim->repeat = false;
-        skeleton_anim->switch_anim(skeleton_anim->idle_anim.get());
-        
-        std::cout << "Spawned new skeleton at (" << x << ", " << y << ")" << std::endl;
+        spawn_named("Skeleton", x, y);
     }
     
     void render() {
-        animation_system.render(ecs);
-        health_system.render_health_bars(ecs);
+        auto start = Clock::now();
+        Rectangle view = camera.view_rect((float)GetScreenWidth(), (float)GetScreenHeight());
+        collect_visible(view);
+        last_timings.render_ms = elapsed_ms(start);
+        
+        // Animations are only advanced for what is about to be drawn
+        start = Clock::now();
+        animation_system.update(ecs, tick(), animating,
+                                [this](Entity unit) { render_index.set_flags(unit, RENDER_SETTLED); });
+        last_timings.animation_ms = elapsed_ms(start);
+        
+        start = Clock::now();
+        BeginMode2D(camera.camera);
+        animation_system.render(ecs, visible);
+        hitbox_system.render(view);
+        health_system.render_health_bars(ecs, visible);
+        EndMode2D();
+        
+        // Screen-space HUD
+        if (action_bar_entity >= 0) {
+            ability_system.render_action_bar(ecs, abilities, action_bar_entity);
+        }
+        last_timings.render_ms += elapsed_ms(start);
+        
+        if (stress.running) {
+            DrawText(TextFormat("STRESS TEST: %d units per side", stress.current_units_per_side()), 10, 10, 20, YELLOW);
+        }
+    }
+    
+    // Culling pass: bring the render index up to date, then take only the units in
+    // the cells the view overlaps, so draw cost follows what is on screen
+    void collect_visible(Rectangle view) {
+        sync_render_index();
+        
+        visible.clear();
+        animating.clear();
+        render_index.query(view, [this](const IncrementalGrid::Item& item) {
+            visible.push_back(item.id);
+            if (!(item.flags & RENDER_SETTLED)) animating.push_back(item.id);
+        });
+        
+        // Painter's order: units standing lower on screen are drawn over those behind them
+        draw_order.clear();
+        for (Entity unit : visible) {
+            draw_order.push_back({ecs.get_component<PositionComponent>(unit)->get_center_bottom().y, unit});
+        }
+        std::sort(draw_order.begin(), draw_order.end());
+        for (size_t i = 0; i < draw_order.size(); i++) {
+            visible[i] = draw_order[i].second;
+        }
+    }
+    
+    // Only units added or moved since the last sync are re-filed (Changed<Position>
+    // covers both); despawned units are dropped where they leave the ECS
+    void sync_render_index() {
+        uint32_t since = render_read;
+        render_read = ecs.read_changes();
+        auto moved = ecs.query<Changed<PositionComponent>, AnimationComponent>(since);
+        for (Entity unit : moved) {
+            auto* pos = ecs.get_component<PositionComponent>(unit);
+            auto* anim = ecs.get_component<AnimationComponent>(unit);
+            
+            // Any clip's sprite plus the health bar drawn just above the unit's rect
+            Rectangle sprite = anim->max_bounds({pos->x, pos->y});
+            float left = std::min(sprite.x, pos->x);
+            float top = std::min(sprite.y, pos->y - 10);
+            float right = std::max(sprite.x + sprite.width, pos->x + std::max(pos->rect.width, 50.0f));
+            float bottom = std::max(sprite.y + sprite.height, pos->y + pos->rect.height);
+            render_index.update(unit, {left, top, right - left, bottom - top});
+        }
+    }
+    
+    // ---- Picking ----
+    
+    // Same order as drawing: by the bottom of the hit rect, then entity id
+    static bool draws_before(const SpatialGrid::Item& a, const SpatialGrid::Item& b) {
+        float ya = a.bounds.y + a.bounds.height;
+        float yb = b.bounds.y + b.bounds.height;
+        return ya != yb ? ya < yb : a.id < b.id;
+    }
+    
+    // Built from the units the attack pass already packed this frame, so picking never
+    // walks the ECS; at most one rebuild per side per update, and only if something is
+    // picked. Units that die later in the same update stay pickable until the next one.
+    const SpatialGrid& pick_grid(int side) {
+        if (pick_grid_ticks[side] != timers.now()) {
+            pick_grid_ticks[side] = timers.now();
+            const PackedPositions& units = attack_system.alive_units(side);
+            const std::vector<Rectangle>& rects = attack_system.alive_unit_rects(side);
+            pick_grids[side].clear();
+            for (int i = 0; i < units.size(); i++) {
+                pick_grids[side].add(units.ids[i], rects[i]);
+            }
+            pick_grids[side].build();
+        }
+        return pick_grids[side];
+    }
+    
+    // Top-most living unit of `side` whose rect contains the point, or -1
+    Entity pick_unit(float x, float y, int side) {
+        if (side < 0 || side > 1) return -1;
+        
+        const SpatialGrid::Item* best = nullptr;
+        pick_grid(side).query({x - 0.5f, y - 0.5f, 1.0f, 1.0f}, [&](const SpatialGrid::Item& item) {
+            const Rectangle& r = item.bounds;
+            if (x < r.x || x > r.x + r.width || y < r.y || y > r.y + r.height) return;
+            if (!best || draws_before(*best, item)) best = &item;
+        });
+        return best ? best->id : -1;
+    }
+    
+    // Living units of `side` overlapping the area, in draw order. Writes up to
+    // capacity ids into out and returns how many matched (may exceed capacity).
+    int select_units(Rectangle area, int side, int* out, int capacity) {
+        if (side < 0 || side > 1) return 0;
+        
+        std::pmr::vector<SpatialGrid::Item> hits(&frame_arena());
+        pick_grid(side).query(area, [&](const SpatialGrid::Item& item) { hits.push_back(item); });
+        std::sort(hits.begin(), hits.end(), draws_before);
+        
+        int written = std::min((int)hits.size(), std::max(capacity, 0));
+        for (int i = 0; i < written; i++) out[i] = hits[i].id;
+        return (int)hits.size();
     }
     
+    Vector2 screen_to_world(Vector2 point) const { return camera.screen_to_world(point); }
+    
     void create_test_units() {
-        // Create player knight
-        Entity knight = ecs.create_entity();
-        // Use proper hitbox size from backup: 40*scale x 50*scale = 80x100
-        ecs.add_component<PositionComponent>(knight, 200, 600, 80, 100);
-        ecs.add_component<HealthComponent>(knight, 1000);
-        ecs.add_component<MovementComponent>(knight, 2.0f);
-        ecs.add_component<AttackComponent>(knight, 60, 10, 120, 30, 15);
-        ecs.add_component<AIComponent>(knight, 0, "Knight"); // Player side
-        
-        ecs.add_component<AnimationComponent>(knight);
-        auto* knight_anim = ecs.get_component<AnimationComponent>(knight);
-        knight_anim->set_player_offsets(); // Set proper player offsets
-        knight_anim->idle_anim = std::make_unique<Animation>("assets/player/Idle.png", 10);
-        knight_anim->move_anim = std::make_unique<Animation>("assets/player/Run.png", 6);
-        knight_anim->attack_anim = std::make_unique<Animation>("assets/player/Attack1.png", 4);
-        knight_anim->attack_anim->repeat = false;
-        knight_anim->hit_anim = std::make_unique<Animation>("assets/player/Get Hit.png", 3);
-        knight_anim->death_anim = std::make_unique<Animation>("assets/player/Death.png", 9);
-        knight_anim->death_anim->repeat = false;
-        knight_anim->switch_anim(knight_anim->idle_anim.get());
-        
-        // Create enemy skeleton with proper attack timing
-        Entity skeleton = ecs.create_entity();
-        // Use proper hitbox size for skeleton (similar proportions)
-        ecs.add_component<PositionComponent>(skeleton, 341, 467, 80, 100);
-        ecs.add_component<HealthComponent>(skeleton, 50);
-        ecs.add_component<MovementComponent>(skeleton, 0.5f);
-        // Skeleton attack: 8 frames * 10 frame_duration = 80 total, swing at frame 3 * 10 = 30
-        ecs.add_component<AttackComponent>(skeleton, 90, 15, 120, 80, 30);
-        ecs.add_component<AIComponent>(skeleton, 1, "Skeleton"); // Enemy side
-        
-        ecs.add_component<AnimationComponent>(skeleton);
-        auto* skeleton_anim = ecs.get_component<AnimationComponent>(skeleton);
-        skeleton_anim->set_enemy_offsets(); // Set proper enemy offsets
-        skeleton_anim->idle_anim = std::make_unique<Animation>("assets/enemies/skeleton/Idle.png", 4, 150);
-        skeleton_anim->move_anim = std::make_unique<Animation>("assets/enemies/skeleton/Walk.png", 4, 150);
-        skeleton_anim->attack_anim = std::make_unique<Animation>("assets/enemies/skeleton/Attack.png", 8, 150);
-        skeleton_anim->attack_anim->repeat = false;
-        skeleton_anim->hit_anim = std::make_unique<Animation>("assets/enemies/skeleton/Take Hit.png", 4, 150);
-        skeleton_anim->death_anim = std::make_unique<Animation>("assets/enemies/skeleton/Death.png", 4, 150);
-        skeleton_anim->death_anim->repeat = false;
-        skeleton_anim->switch_anim(skeleton_anim->idle_anim.get());
+        const UnitPrefab* knight = prefabs.find("Knight");
+        const UnitPrefab* skeleton = prefabs.find("Skeleton");
+        if (!knight || !skeleton) {
+            std::cout << "Missing Knight/Skeleton prefabs, no test units created" << std::endl;
+            return;
+        }
+        
+        spawn_batch(*knight, {{200, 600}, {400, 600}, {600, 600}});
+        spawn_batch(*skeleton, {{341, 467}, {500, 400}, {700, 400}});
         
         std::cout << "Battle system initialized with ECS architecture" << std::endl;
-        std::cout << "Knight entity: " << knight << ", Skeleton entity: " << skeleton << std::endl;
-        std::cout << "Press S to spawn a new skeleton for testing" << std::endl;
-
-        // Spawn 2 additional players and 2 additional skeletons
-        spawn_player(400, 600);  // Second player
-        spawn_player(600, 600);  // Third player
-        spawn_skeleton_at(500, 400);  // Second skeleton
-        spawn_skeleton_at(700, 400);  // Third skeleton
+        std::cout << "Press S to spawn a random enemy for testing" << std::endl;
     }
     
     ECS& get_ecs() { return ecs; }
     
+    int alive_count(int side) {
+        int count = 0;
+        auto units = ecs.get_entities_with<HealthComponent, AIComponent>();
+        for (Entity unit : units) {
+            if (ecs.get_component<AIComponent>(unit)->side == side &&
+                !ecs.get_component<HealthComponent>(unit)->is_dead) count++;
+        }
+        return count;
+    }
+    
+    void set_hide_full_hp_bars(bool hide) { health_system.hide_full_hp_bars = hide; }
+    void set_ai_budget_us(int microseconds) { attack_system.scheduler.budget_us = microseconds; }
+    
+    // Skill input goes through the command queue; it runs at the next update
+    void queue_cast(Entity entity, int slot) { ability_system.queue_cast(entity, slot); }
+    
+    // Group orders are stamped with the current tick so held-click repeats coalesce
+    void command_move(const int* units, int count, Vector2 point) {
+        command_system.move_group(units, count, point, timers.now());
+    }
+    void command_attack(const int* units, int count, Entity target) {
+        command_system.attack_group(units, count, target, timers.now());
+    }
+    void set_action_bar_entity(Entity entity) { action_bar_entity = entity; }
+    
     void handle_input() {
+        camera.handle_input();
+        
         // Handle spawn command (S key)
         if (IsKeyPressed(KEY_S)) {
-            spawn_skeleton();
+            spawn_random_enemy();
+        }
+        
+        // Start the scaling stress test (F1)
+        if (IsKeyPressed(KEY_F1) && !stress.running) {
+            begin_stress_test("stress_report.csv");
+        }
+        
+        // Area attack test: every living player unit swings a hitbox (H key)
+        if (IsKeyPressed(KEY_H)) {
+            spawn_test_area_attack();
+        }
+        
+        // Compare the batched distance kernel against the scalar path (B key)
+        if (IsKeyPressed(KEY_B)) {
+            benchmark_distance_kernels();
+        }
+        
+        // Effects test: poison and slow every living enemy for 5 seconds (P key)
+        if (IsKeyPressed(KEY_P)) {
+            apply_test_effects();
+        }
+        
+        // Dump tracked memory by category (M key)
+        if (IsKeyPressed(KEY_M)) {
+            dump_memory_report("memory_report.csv");
+        }
+        
+        // Toggle hitbox outlines (F2)
+        if (IsKeyPressed(KEY_F2)) {
+            hitbox_system.draw_debug = !hitbox_system.draw_debug;
+        }
+    }
+    
+    // ===== Memory accounting =====
+    
+    // Component objects plus ECS tables, divided by live entities
+    double unit_bytes() const {
+        if (ecs.entity_count() == 0) return 0;
+        MemoryTracker& tracker = MemoryTracker::instance();
+        int64_t bytes = tracker.bytes_with_prefix("component/") + tracker.bytes_with_prefix("ecs/");
+        return (double)bytes / ecs.entity_count();
+    }
+    
+    void dump_memory_report(const std::string& filename) {
+        MemoryTracker& tracker = MemoryTracker::instance();
+        tracker.dump(filename, ecs.entity_count());
+        std::cout << "Tracked memory: " << tracker.bytes_with_prefix("component/") / 1024 << " KiB components, "
+                  << tracker.bytes_with_prefix("ecs/") / 1024 << " KiB ECS tables, "
+                  << tracker.bytes_with_prefix("assets/") / 1024 << " KiB assets; "
+                  << unit_bytes() << " bytes per unit (" << ecs.entity_count() << " units)" << std::endl;
+    }
+    
+    void apply_test_effects() {
+        auto units = ecs.get_entities_with<HealthComponent, AIComponent>();
+        int applied = 0;
+        for (Entity unit : units) {
+            if (ecs.get_component<AIComponent>(unit)->side != 1) continue;
+            if (effect_system.apply(ecs, unit, EFFECT_DAMAGE_OVER_TIME, 2, 300, 30)) applied++;
+            effect_system.apply(ecs, unit, EFFECT_STAT_MODIFIER, -50, 300, 1, STAT_SPEED_PERCENT);
+        }
+        std::cout << "Poisoned and slowed " << applied << " enemies (" << effect_system.active_count()
+                  << " active effects)" << std::endl;
+    }
+    
+    void spawn_test_area_attack() {
+        auto units = ecs.get_entities_with<HealthComponent, AIComponent>();
+        for (Entity unit : units) {
+            auto* ai = ecs.get_component<AIComponent>(unit);
+            if (ai->side != 0 || ecs.get_component<HealthComponent>(unit)->is_dead) continue;
+            hitbox_system.spawn(unit, ai->side, 120, 100, 10);
         }
     }
     
     // Public spawn functions are already implemented above
 };
 
-// Global battle system instance
-BattleSystem* g_battle_system = nullptr;
-
-// Export functions for use by main.cpp and BattleScene
+// Export functions for use by main.cpp and BattleScene. Every battle is its own
+// BattleSystem behind a handle; there is no global battle.
 extern "C" {
-    void initialize_battle_system() {
-        if (!g_battle_system) {
-            g_battle_system = new BattleSystem();
-            g_battle_system->initialize();
+    BattleHandle battle_create(unsigned long long seed, int headless) {
+        BattleSystem* battle = new BattleSystem(headless != 0, seed);
+        battle->initialize();
+        if (headless) {
+            // A time budget would make results depend on machine load; headless
+            // outcomes should be a pure function of the seed
+            battle->set_ai_budget_us(0);
         }
+        return battle;
     }
     
-    void update_battle_system() {
-        if (g_battle_system) {
-            g_battle_system->handle_input(); // Handle spawn commands
-            g_battle_system->update();
+    // Each tick starts a fresh frame arena on the calling thread, so callers must not
+    // hold frame arena memory across this call
+    void battle_step(BattleHandle battle, int ticks) {
+        if (!battle) return;
+        for (int i = 0; i < ticks; i++) {
+            frame_arena().reset();
+            battle->update();
         }
     }
     
-    void render_battle_system() {
-        if (g_battle_system) {
-            g_battle_system->render();
+    void battle_handle_input(BattleHandle battle) {
+        if (battle) {
+            battle->handle_input(); // Handle spawn commands
         }
     }
     
-    void cleanup_battle_system() {
-        if (g_battle_system) {
-            delete g_battle_system;
-            g_battle_system = nullptr;
+    void battle_render(BattleHandle battle) {
+        if (battle) {
+            battle->render();
         }
     }
     
-    // MOBA control functions
-    int get_entity_at_position(float x, float y, int side) {
-        if (!g_battle_system) return -1;
-        
-        auto entities = g_battle_system->get_ecs().get_entities_with<PositionComponent, AIComponent>();
-        
-        std::cout << "Click at (" << x << ", " << y << ") looking for side " << side << std::endl;
-        
-        for (Entity entity : entities) {
-            auto* pos = g_battle_system->get_ecs().get_component<PositionComponent>(entity);
-            auto* ai = g_battle_system->get_ecs().get_component<AIComponent>(entity);
-            
-            std::cout << "  Entity " << entity << " (" << ai->type_name << ") at (" 
-                      << pos->rect.x << ", " << pos->rect.y << ") size " 
-                      << pos->rect.width << "x" << pos->rect.height 
-                      << " side=" << ai->side << std::endl;
-            
-            if (ai->side == side) {
-                // Check if click is within entity bounds
-                if (x >= pos->rect.x && x <= pos->rect.x + pos->rect.width &&
-                    y >= pos->rect.y && y <= pos->rect.y + pos->rect.height) {
-                    std::cout << "  -> HIT! Selecting entity " << entity << std::endl;
-                    return entity;
-                }
-            }
+    void battle_destroy(BattleHandle battle) {
+        delete battle;
+    }
+    
+    // Mouse positions are in screen space; unit positions and move targets in world space
+    void battle_screen_to_world(BattleHandle battle, float* x, float* y) {
+        if (!battle) return;
+        Vector2 world = battle->screen_to_world({*x, *y});
+        *x = world.x;
+        *y = world.y;
+    }
+    
+    int battle_alive_count(BattleHandle battle, int side) {
+        return battle ? battle->alive_count(side) : 0;
+    }
+    
+    int battle_winner(BattleHandle battle) {
+        if (!battle) return -1;
+        int players = battle->alive_count(0);
+        int enemies = battle->alive_count(1);
+        if (players > 0 && enemies > 0) return -1;
+        return players > 0 ? 0 : 1;
+    }
+    
+    void set_health_bar_options(BattleHandle battle, int hide_full_hp) {
+        if (battle) {
+            battle->set_hide_full_hp_bars(hide_full_hp != 0);
+        }
+    }
+    
+    // Per-frame time for enemy target decisions; 0 or less re-decides every unit every frame
+    void set_ai_time_budget(BattleHandle battle, int microseconds) {
+        if (battle) {
+            battle->set_ai_budget_us(microseconds);
+        }
+    }
+    
+    // Stress test: ramps unit counts, writes per-step timings to report_path
+    void start_battle_stress_test(BattleHandle battle, const char* report_path) {
+        if (battle) {
+            battle->begin_stress_test(report_path);
+        }
+    }
+    
+    // Cold-start asset load with and without the cooked pack; needs a (hidden) window
+    void run_asset_load_benchmark() {
+        double png_ms, pack_ms;
+        {
+            BattleSystem battle;
+            png_ms = battle.load_assets(false);
+        }
+        {
+            BattleSystem battle;
+            pack_ms = battle.load_assets(true);
+        }
+        std::cout << "Asset cold start: " << png_ms << " ms from PNG, " << pack_ms << " ms from pack" << std::endl;
+    }
+    
+    // Runs the whole ramp without a window or textures, then returns
+    void run_headless_stress_test(const char* report_path, unsigned long long seed) {
+        BattleSystem battle(true, seed);
+        battle.initialize();
+        battle.begin_stress_test(report_path);
+        while (battle.stress_test_running()) {
+            frame_arena().reset();
+            battle.update();
         }
-        std::cout << "  -> No entity found at click position" << std::endl;
-        return -1;
     }
     
-    void set_entity_target_location(int entity, float x, float y) {
-        if (!g_battle_system) return;
+    // Skill slot 0-3 = Q/W/E/R; cast at the start of the next battle update
+    void cast_entity_ability(BattleHandle battle, int entity, int slot) {
+        if (battle) {
+            battle->queue_cast(entity, slot);
+        }
+    }
+    
+    // Unit whose abilities the top-left action bar shows, -1 to hide it
+    void set_action_bar_entity(BattleHandle battle, int entity) {
+        if (battle) {
+            battle->set_action_bar_entity(entity);
+        }
+    }
+    
+    // MOBA control functions
+    int get_entity_at_position(BattleHandle battle, float x, float y, int side) {
+        if (!battle) return -1;
+        return battle->pick_unit(x, y, side);
+    }
+    
+    // Drag box in world space, corners in any order
+    int select_entities_in_rect(BattleHandle battle, float x0, float y0, float x1, float y1, int side,
+                                int* out, int capacity) {
+        if (!battle) return 0;
+        Rectangle area = {std::min(x0, x1), std::min(y0, y1), std::fabs(x1 - x0), std::fabs(y1 - y0)};
+        return battle->select_units(area, side, out, capacity);
+    }
+    
+    void set_entity_target_location(BattleHandle battle, int entity, float x, float y) {
+        if (!battle) return;
         
-        auto* ai = g_battle_system->get_ecs().get_component<AIComponent>(entity);
+        auto* ai = battle->get_ecs().get_component<AIComponent>(entity);
         if (ai) {
             // Create a dummy target entity at the location for movement (like backup system)
             // Clear enemy target and set movement target (like backup system)
@@ -972,10 +3551,10 @@ extern "C" {
         }
     }
     
-    void set_entity_target_enemy(int entity, int target_entity) {
-        if (!g_battle_system) return;
+    void set_entity_target_enemy(BattleHandle battle, int entity, int target_entity) {
+        if (!battle) return;
         
-        auto* ai = g_battle_system->get_ecs().get_component<AIComponent>(entity);
+        auto* ai = battle->get_ecs().get_component<AIComponent>(entity);
         if (ai) {
             ai->target_entity = target_entity;
             ai->has_target = true;
@@ -983,14 +3562,26 @@ extern "C" {
         }
     }
     
+    // Selection orders: move into formation around (x, y), or all attack one enemy.
+    // Queued and applied in one batch at the start of the next step.
+    void command_group_move(BattleHandle battle, const int* units, int count, float x, float y) {
+        if (!battle || !units) return;
+        battle->command_move(units, count, {x, y});
+    }
+    
+    void command_group_attack(BattleHandle battle, const int* units, int count, int target_entity) {
+        if (!battle || !units) return;
+        battle->command_attack(units, count, target_entity);
+    }
+    
     // Spawn functions
-    void spawn_player_at(float x, float y) {
-        if (!g_battle_system) return;
-        g_battle_system->spawn_player(x, y);
+    void spawn_player_at(BattleHandle battle, float x, float y) {
+        if (!battle) return;
+        battle->spawn_player(x, y);
     }
     
-    void spawn_skeleton_at_position(float x, float y) {
-        if (!g_battle_system) return;
-        g_battle_system->spawn_skeleton_at(x, y);
+    void spawn_skeleton_at_position(BattleHandle battle, float x, float y) {
+        if (!battle) return;
+        battle->spawn_skeleton_at(x, y);
     }
-}
\ No newline at end of file
+}
@@ -1,13 +1,49 @@
 #pragma once
 
+// One battle instance. Battles share no mutable state, so different handles can be
+// stepped on different threads (server auto-resolve, balance runs); a single handle
+// must only be used by one thread at a time.
+class BattleSystem;
+typedef BattleSystem* BattleHandle;
+
 extern "C" {
-    void initialize_battle_system();
-    void update_battle_system();
-    void render_battle_system();
-    void cleanup_battle_system();
+    // Windowed battles upload textures, so create them on the window's thread.
+    // Headless battles load no textures and skip per-unit logging.
+    BattleHandle battle_create(unsigned long long seed, int headless); // Seeds the spawn/combat RNG streams
+    void battle_step(BattleHandle battle, int ticks); // Resets the calling thread's frame arena each tick
+    void battle_handle_input(BattleHandle battle);    // Debug keys: spawn, stress test, effects...
+    void battle_render(BattleHandle battle);
+    void battle_destroy(BattleHandle battle);
+    void battle_screen_to_world(BattleHandle battle, float* x, float* y); // Through the battle camera
+    int battle_alive_count(BattleHandle battle, int side);
+    int battle_winner(BattleHandle battle); // Side with units left, -1 while both sides fight
+    
+    void set_health_bar_options(BattleHandle battle, int hide_full_hp); // Skip bars of units at full HP
+    void set_ai_time_budget(BattleHandle battle, int microseconds); // Enemy decision time per frame, <= 0 for unlimited
+    
+    // Scaling stress test (100 -> 5000 units per side), report written as CSV
+    void start_battle_stress_test(BattleHandle battle, const char* report_path);
+    void run_headless_stress_test(const char* report_path, unsigned long long seed);
+    void run_asset_load_benchmark(); // Startup texture load time, PNG decode vs cooked pack
+    
+    void spawn_player_at(BattleHandle battle, float x, float y);            // Knight prefab
+    void spawn_skeleton_at_position(BattleHandle battle, float x, float y); // Skeleton prefab
     
     // Functions to interact with ECS for MOBA controls
-    int get_entity_at_position(float x, float y, int side); // Returns entity ID or -1
-    void set_entity_target_location(int entity, float x, float y);
-    void set_entity_target_enemy(int entity, int target_entity);
-}
\ No newline at end of file
+    int get_entity_at_position(BattleHandle battle, float x, float y, int side); // Top-most living unit, or -1
+    // Living units of `side` touching the box (world space, corners in any order), in draw order.
+    // Writes at most capacity IDs to out; returns the total number found.
+    int select_entities_in_rect(BattleHandle battle, float x0, float y0, float x1, float y1, int side,
+                                int* out, int capacity);
+    void set_entity_target_location(BattleHandle battle, int entity, float x, float y);
+    void set_entity_target_enemy(BattleHandle battle, int entity, int target_entity);
+    
+    // Orders for a whole selection, applied in one batch on the next step. Repeating the
+    // previous step's command (e.g. every frame while a click is held) is a no-op.
+    void command_group_move(BattleHandle battle, const int* units, int count, float x, float y); // Formation around (x, y)
+    void command_group_attack(BattleHandle battle, const int* units, int count, int target_entity);
+    
+    // Q/W/E/R skills: slot 0-3, queued and cast on the next update
+    void cast_entity_ability(BattleHandle battle, int entity, int slot);
+    void set_action_bar_entity(BattleHandle battle, int entity); // -1 hides the action bar
+}
@@ -0,0 +1,204 @@
+// CombatKernels.h - Batched distance kernels for combat target searches
+//
+// Positions are packed structure-of-arrays style (all x's, then all y's) so one
+// unit can be compared against every candidate in a single pass. The widest
+// instruction set enabled at compile time is used (AVX2, then SSE2) and the
+// scalar loop handles the remainder and any other target. AVX2 is only enabled
+// when configured with -DSEARCHING_AVX2=ON.
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cfloat>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define COMBAT_KERNELS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define COMBAT_KERNELS_SSE2 1
+#endif
+
+// Candidate positions for one side of the battle, rebuilt once per frame
+struct PackedPositions {
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<int> ids;   // Entity id for each packed slot
+
+    void clear() {
+        xs.clear();
+        ys.clear();
+        ids.clear();
+    }
+
+    void reserve(size_t count) {
+        xs.reserve(count);
+        ys.reserve(count);
+        ids.reserve(count);
+    }
+
+    void push(int id, float x, float y) {
+        ids.push_back(id);
+        xs.push_back(x);
+        ys.push_back(y);
+    }
+
+    int size() const { return (int)ids.size(); }
+};
+
+// ==================== SCALAR REFERENCE ====================
+
+inline int nearest_index_scalar(float px, float py, const float* xs, const float* ys, int count,
+                                float* out_dist_sq = nullptr) {
+    int best = -1;
+    float best_dist_sq = FLT_MAX;
+    for (int i = 0; i < count; i++) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        float dist_sq = dx*dx + dy*dy;
+        if (dist_sq < best_dist_sq) {
+            best_dist_sq = dist_sq;
+            best = i;
+        }
+    }
+    if (out_dist_sq) *out_dist_sq = best_dist_sq;
+    return best;
+}
+
+// ==================== VECTORIZED KERNELS ====================
+
+// Index of the closest candidate (-1 if none). Ties resolve to the lowest index,
+// matching the scalar path.
+inline int nearest_index(float px, float py, const float* xs, const float* ys, int count,
+                         float* out_dist_sq = nullptr) {
+    int i = 0;
+    int best = -1;
+    float best_dist_sq = FLT_MAX;
+
+#if defined(COMBAT_KERNELS_AVX2)
+    if (count >= 8) {
+        __m256 vpx = _mm256_set1_ps(px);
+        __m256 vpy = _mm256_set1_ps(py);
+        __m256 best_d = _mm256_set1_ps(FLT_MAX);
+        __m256i best_i = _mm256_set1_epi32(-1);
+        __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i step = _mm256_set1_epi32(8);
+        for (; i + 8 <= count; i += 8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vpx);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vpy);
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            __m256 closer = _mm256_cmp_ps(d, best_d, _CMP_LT_OQ);
+            best_d = _mm256_blendv_ps(best_d, d, closer);
+            best_i = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_i),
+                                                          _mm256_castsi256_ps(idx), closer));
+            idx = _mm256_add_epi32(idx, step);
+        }
+        alignas(32) float lane_d[8];
+        alignas(32) int lane_i[8];
+        _mm256_store_ps(lane_d, best_d);
+        _mm256_store_si256((__m256i*)lane_i, best_i);
+        for (int l = 0; l < 8; l++) {
+            if (lane_i[l] < 0) continue;
+            if (lane_d[l] < best_dist_sq || (lane_d[l] == best_dist_sq && lane_i[l] < best)) {
+                best_dist_sq = lane_d[l];
+                best = lane_i[l];
+            }
+        }
+    }
+#elif defined(COMBAT_KERNELS_SSE2)
+    if (count >= 4) {
+        __m128 vpx = _mm_set1_ps(px);
+        __m128 vpy = _mm_set1_ps(py);
+        __m128 best_d = _mm_set1_ps(FLT_MAX);
+        __m128i best_i = _mm_set1_epi32(-1);
+        __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i step = _mm_set1_epi32(4);
+        for (; i + 4 <= count; i += 4) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vpx);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), vpy);
+            __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            // SSE2 has no blendv - select with and/andnot/or
+            __m128 closer = _mm_cmplt_ps(d, best_d);
+            best_d = _mm_or_ps(_mm_and_ps(closer, d), _mm_andnot_ps(closer, best_d));
+            __m128i closer_i = _mm_castps_si128(closer);
+            best_i = _mm_or_si128(_mm_and_si128(closer_i, idx), _mm_andnot_si128(closer_i, best_i));
+            idx = _mm_add_epi32(idx, step);
+        }
+        alignas(16) float lane_d[4];
+        alignas(16) int lane_i[4];
+        _mm_store_ps(lane_d, best_d);
+        _mm_store_si128((__m128i*)lane_i, best_i);
+        for (int l = 0; l < 4; l++) {
+            if (lane_i[l] < 0) continue;
+            if (lane_d[l] < best_dist_sq || (lane_d[l] == best_dist_sq && lane_i[l] < best)) {
+                best_dist_sq = lane_d[l];
+                best = lane_i[l];
+            }
+        }
+    }
+#endif
+
+    // Remainder (or the whole array without SIMD)
+    for (; i < count; i++) {
+        float dx = xs[i] - px;
+        float dy = ys[i] - py;
+        float dist_sq = dx*dx + dy*dy;
+        if (dist_sq < best_dist_sq) {
+            best_dist_sq = dist_sq;
+            best = i;
+        }
+    }
+
+    if (out_dist_sq) *out_dist_sq = best_dist_sq;
+    return best;
+}
+
+// ==================== BENCHMARK ====================
+
+// Times every attacker searching every candidate with both paths and prints the result
+inline void benchmark_distance_kernels(int count = 1000, int iterations = 200) {
+    std::vector<float> xs(count), ys(count);
+    uint32_t state = 12345u;
+    for (int i = 0; i < count; i++) {
+        state = state * 1664525u + 1013904223u;
+        xs[i] = (float)(state % 4000);
+        state = state * 1664525u + 1013904223u;
+        ys[i] = (float)(state % 4000);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    long long checksum_scalar = 0, checksum_simd = 0;
+
+    auto start = Clock::now();
+    for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < count; i++) {
+            checksum_scalar += nearest_index_scalar(xs[i] + 0.5f, ys[i] + 0.5f, xs.data(), ys.data(), count);
+        }
+    }
+    double scalar_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < count; i++) {
+            checksum_simd += nearest_index(xs[i] + 0.5f, ys[i] + 0.5f, xs.data(), ys.data(), count);
+        }
+    }
+    double simd_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+#if defined(COMBAT_KERNELS_AVX2)
+    const char* path = "AVX2";
+#elif defined(COMBAT_KERNELS_SSE2)
+    const char* path = "SSE2";
+#else
+    const char* path = "scalar";
+#endif
+
+    std::cout << "Distance kernel benchmark (" << count << " units, " << iterations << " iterations)" << std::endl;
+    std::cout << "  scalar: " << scalar_ms << " ms" << std::endl;
+    std::cout << "  " << path << ": " << simd_ms << " ms (x" << (simd_ms > 0 ? scalar_ms / simd_ms : 0) << ")" << std::endl;
+    if (checksum_scalar != checksum_simd) {
+        std::cout << "  WARNING: kernel results differ from scalar path" << std::endl;
+    }
+}
@@ -0,0 +1,349 @@
+// DungeonGenerator.h - Procedural floor generation for the dungeon crawler
+//
+// Floors are stored flat (row-major, one byte per room) so a 256x256 floor is a
+// single 64 KiB allocation. Special rooms are placed with a partial Fisher-Yates
+// shuffle over the candidate cells: O(cells) to set up, O(special rooms) to place.
+//
+// ChunkedFloor splits very large floors into CHUNK_SIZE x CHUNK_SIZE chunks that
+// are generated from the floor seed on first visit, evicted least-recently-used,
+// and only written to disk once the player changes them.
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <list>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Random.h"
+
+// Room types - values are written to rooms.txt, keep them stable
+enum RoomType : uint8_t {
+    ROOM_CLEAR,
+    ROOM_TREASURE,
+    ROOM_ENEMY,
+    ROOM_BOSS,
+    ROOM_WALL  // Out of bounds
+};
+
+struct FloorParams {
+    int width = 5;
+    int height = 5;
+    int start_x = 2;             // Starting room, always clear
+    int start_y = 2;
+    int boss_count = 1;
+    float treasure_ratio = 0.125f;  // Share of non-start rooms holding treasure (3 of 24 on 5x5)
+    float clear_ratio = 0.0f;       // Share of non-start rooms that start out empty
+    uint32_t seed = 0;
+
+    // Square floor of the given size with the start room in the middle
+    static FloorParams square(int size) {
+        FloorParams params;
+        params.width = size;
+        params.height = size;
+        params.start_x = size / 2;
+        params.start_y = size / 2;
+        return params;
+    }
+};
+
+// A whole floor held in memory. The dungeon scene streams ChunkedFloor instead; this
+// is the single-pass generator --dungeon-bench measures chunked generation against.
+struct FloorLayout {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rooms;  // rooms[y * width + x]
+
+    bool in_bounds(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    RoomType at(int x, int y) const {
+        if (!in_bounds(x, y)) return ROOM_WALL;
+        return (RoomType)rooms[y * width + x];
+    }
+
+    void set(int x, int y, RoomType type) {
+        if (in_bounds(x, y)) rooms[y * width + x] = type;
+    }
+};
+
+inline FloorLayout generate_floor(const FloorParams& params) {
+    FloorLayout layout;
+    layout.width = params.width;
+    layout.height = params.height;
+    layout.rooms.assign((size_t)params.width * params.height, ROOM_ENEMY);
+    if (layout.rooms.empty()) return layout;
+
+    uint32_t start = (uint32_t)(params.start_y * params.width + params.start_x);
+    layout.rooms[start] = ROOM_CLEAR;
+
+    // Every room except the start is a candidate
+    std::vector<uint32_t> spots;
+    spots.reserve(layout.rooms.size() - 1);
+    for (uint32_t i = 0; i < (uint32_t)layout.rooms.size(); i++) {
+        if (i != start) spots.push_back(i);
+    }
+
+    uint32_t available = (uint32_t)spots.size();
+    uint32_t bosses = std::min<uint32_t>((uint32_t)std::max(params.boss_count, 0), available);
+    uint32_t treasures = std::min<uint32_t>((uint32_t)(params.treasure_ratio * available + 0.5f), available - bosses);
+    uint32_t clears = std::min<uint32_t>((uint32_t)(params.clear_ratio * available + 0.5f), available - bosses - treasures);
+    uint32_t special = bosses + treasures + clears;
+
+    // Partial Fisher-Yates: only the first `special` slots are shuffled into place
+    Xoshiro128pp rng(params.seed);
+    for (uint32_t i = 0; i < special; i++) {
+        std::swap(spots[i], spots[i + rng.below(available - i)]);
+
+        RoomType type = (i < bosses) ? ROOM_BOSS : (i < bosses + treasures) ? ROOM_TREASURE : ROOM_CLEAR;
+        layout.rooms[spots[i]] = type;
+    }
+
+    // Remaining rooms stay as ROOM_ENEMY
+    return layout;
+}
+
+// Times generation of a size x size floor and prints the result
+inline double benchmark_floor_generation(int size = 256, int runs = 20) {
+    FloorParams params = FloorParams::square(size);
+    double best_ms = 0;
+    size_t rooms = 0;
+    for (int run = 0; run < runs; run++) {
+        params.seed = (uint32_t)run;
+        auto start = std::chrono::steady_clock::now();
+        FloorLayout layout = generate_floor(params);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        rooms = layout.rooms.size();
+        if (run == 0 || ms < best_ms) best_ms = ms;
+    }
+    std::cout << "Generated " << size << "x" << size << " floor (" << rooms << " rooms) in " << best_ms
+              << " ms (best of " << runs << ", frame budget 16.6 ms)" << std::endl;
+    return best_ms;
+}
+
+// ==================== CHUNKED FLOORS ====================
+
+class ChunkedFloor {
+public:
+    static const int CHUNK_SIZE = 16;
+
+private:
+    struct Chunk {
+        uint8_t rooms[CHUNK_SIZE * CHUNK_SIZE];
+        std::list<uint64_t>::iterator lru_position;
+    };
+
+    FloorParams params;
+    int floor_number = 1;
+    std::string chunk_dir;
+    size_t max_resident_chunks = 64;
+
+    std::vector<uint32_t> boss_cells;                 // Floor-wide, derived from the seed
+    std::unordered_map<uint64_t, Chunk> resident;
+    std::list<uint64_t> lru;                          // Front = most recently used
+    std::unordered_set<uint64_t> modified;            // Chunks with a file on disk
+
+    static uint64_t chunk_key(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+
+    // Deterministic per-chunk seed (splitmix64 finalizer over floor seed and coords)
+    uint32_t chunk_seed(int cx, int cy) const {
+        uint64_t z = ((uint64_t)params.seed << 32) ^ chunk_key(cx, cy) ^ 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)(z ^ (z >> 31));
+    }
+
+    std::string chunk_path(int cx, int cy) const {
+        return chunk_dir + "/floor" + std::to_string(floor_number) + "_" +
+               std::to_string(cx) + "_" + std::to_string(cy) + ".txt";
+    }
+
+    void place_bosses() {
+        boss_cells.clear();
+        uint32_t cells = (uint32_t)params.width * params.height;
+        uint32_t start = (uint32_t)(params.start_y * params.width + params.start_x);
+        if (cells <= 1) return;
+
+        Xoshiro128pp rng(params.seed);
+        while ((int)boss_cells.size() < params.boss_count && boss_cells.size() < cells - 1) {
+            uint32_t cell = rng.below(cells);
+            if (cell == start || std::find(boss_cells.begin(), boss_cells.end(), cell) != boss_cells.end()) continue;
+            boss_cells.push_back(cell);
+        }
+    }
+
+    // Same partial Fisher-Yates as generate_floor, restricted to one chunk.
+    // Boss rooms are placed first and left out of the candidates, so they never
+    // replace a treasure room and every chunk gets its full share.
+    void generate_chunk(int cx, int cy, Chunk& chunk) const {
+        std::fill(std::begin(chunk.rooms), std::end(chunk.rooms), (uint8_t)ROOM_WALL);
+
+        for (uint32_t cell : boss_cells) {
+            int x = (int)(cell % params.width), y = (int)(cell / params.width);
+            if (x / CHUNK_SIZE == cx && y / CHUNK_SIZE == cy) {
+                chunk.rooms[(y % CHUNK_SIZE) * CHUNK_SIZE + (x % CHUNK_SIZE)] = ROOM_BOSS;
+            }
+        }
+
+        std::vector<uint16_t> spots;
+        spots.reserve(CHUNK_SIZE * CHUNK_SIZE);
+        for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+            for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+                int x = cx * CHUNK_SIZE + lx, y = cy * CHUNK_SIZE + ly;
+                if (x >= params.width || y >= params.height) continue;
+                int local = ly * CHUNK_SIZE + lx;
+                if (chunk.rooms[local] == ROOM_BOSS) continue;
+                if (x == params.start_x && y == params.start_y) {
+                    chunk.rooms[local] = ROOM_CLEAR;
+                    continue;
+                }
+                chunk.rooms[local] = ROOM_ENEMY;
+                spots.push_back((uint16_t)local);
+            }
+        }
+
+        uint32_t available = (uint32_t)spots.size();
+        uint32_t treasures = std::min<uint32_t>((uint32_t)(params.treasure_ratio * available + 0.5f), available);
+        uint32_t clears = std::min<uint32_t>((uint32_t)(params.clear_ratio * available + 0.5f), available - treasures);
+
+        Xoshiro128pp rng(chunk_seed(cx, cy));
+        for (uint32_t i = 0; i < treasures + clears; i++) {
+            std::swap(spots[i], spots[i + rng.below(available - i)]);
+            chunk.rooms[spots[i]] = (i < treasures) ? ROOM_TREASURE : ROOM_CLEAR;
+        }
+    }
+
+    bool load_chunk_file(int cx, int cy, Chunk& chunk) const {
+        std::ifstream file(chunk_path(cx, cy));
+        if (!file.is_open()) return false;
+        std::string row;
+        for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+            if (!std::getline(file, row) || (int)row.size() < CHUNK_SIZE) return false;
+            for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+                chunk.rooms[ly * CHUNK_SIZE + lx] = (uint8_t)(row[lx] - '0');
+            }
+        }
+        return true;
+    }
+
+    void save_chunk_file(int cx, int cy, const Chunk& chunk) const {
+        std::error_code ec;
+        std::filesystem::create_directories(chunk_dir, ec);
+        std::ofstream file(chunk_path(cx, cy));
+        if (!file.is_open()) return;
+        for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+            for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+                file << (char)('0' + chunk.rooms[ly * CHUNK_SIZE + lx]);
+            }
+            file << '\n';
+        }
+    }
+
+    Chunk& fetch(int cx, int cy) {
+        uint64_t key = chunk_key(cx, cy);
+        auto it = resident.find(key);
+        if (it != resident.end()) {
+            lru.splice(lru.begin(), lru, it->second.lru_position);
+            return it->second;
+        }
+
+        // Evict before inserting so resident memory never exceeds the cap
+        while (resident.size() >= max_resident_chunks && !lru.empty()) {
+            resident.erase(lru.back());
+            lru.pop_back();
+        }
+
+        Chunk& chunk = resident[key];
+        if (!modified.count(key) || !load_chunk_file(cx, cy, chunk)) {
+            generate_chunk(cx, cy, chunk);
+        }
+        lru.push_front(key);
+        chunk.lru_position = lru.begin();
+        return chunk;
+    }
+
+public:
+    ChunkedFloor(const std::string& dir = "data/temp_data/floor_chunks") : chunk_dir(dir) {}
+
+    // Start a fresh floor; nothing is generated until rooms are looked at
+    void reset(const FloorParams& floor_params, int floor, const std::vector<uint64_t>& modified_chunks = {}) {
+        params = floor_params;
+        floor_number = floor;
+        resident.clear();
+        lru.clear();
+        modified.clear();
+        modified.insert(modified_chunks.begin(), modified_chunks.end());
+        place_bosses();
+    }
+
+    const FloorParams& get_params() const { return params; }
+    int width() const { return params.width; }
+    int height() const { return params.height; }
+    size_t resident_chunks() const { return resident.size(); }
+    size_t resident_limit() const { return max_resident_chunks; }
+
+    bool in_bounds(int x, int y) const {
+        return x >= 0 && x < params.width && y >= 0 && y < params.height;
+    }
+
+    RoomType at(int x, int y) {
+        if (!in_bounds(x, y)) return ROOM_WALL;
+        Chunk& chunk = fetch(x / CHUNK_SIZE, y / CHUNK_SIZE);
+        return (RoomType)chunk.rooms[(y % CHUNK_SIZE) * CHUNK_SIZE + (x % CHUNK_SIZE)];
+    }
+
+    // Changes a room and streams only its chunk to disk
+    void set(int x, int y, RoomType type) {
+        if (!in_bounds(x, y)) return;
+        int cx = x / CHUNK_SIZE, cy = y / CHUNK_SIZE;
+        Chunk& chunk = fetch(cx, cy);
+        chunk.rooms[(y % CHUNK_SIZE) * CHUNK_SIZE + (x % CHUNK_SIZE)] = type;
+        save_chunk_file(cx, cy, chunk);
+        modified.insert(chunk_key(cx, cy));
+    }
+
+    std::vector<uint64_t> modified_chunks() const {
+        return std::vector<uint64_t>(modified.begin(), modified.end());
+    }
+
+    static int key_x(uint64_t key) { return (int)(uint32_t)(key >> 32); }
+    static int key_y(uint64_t key) { return (int)(uint32_t)key; }
+    static uint64_t make_key(int cx, int cy) { return chunk_key(cx, cy); }
+};
+
+// Walks every chunk of a size x size floor, generating each one and evicting through
+// the LRU once the resident cap is reached, and prints the best of `runs` seeds
+inline double benchmark_chunked_floor(int size = 256, int runs = 20) {
+    FloorParams params = FloorParams::square(size);
+    ChunkedFloor floor;  // Nothing is modified, so no chunk files are written
+    int chunks_x = (size + ChunkedFloor::CHUNK_SIZE - 1) / ChunkedFloor::CHUNK_SIZE;
+    int chunk_count = chunks_x * chunks_x;
+    double best_ms = 0;
+    size_t peak_resident = 0;
+    for (int run = 0; run < runs; run++) {
+        params.seed = (uint32_t)run;
+        floor.reset(params, 1);
+        auto start = std::chrono::steady_clock::now();
+        for (int cy = 0; cy < chunks_x; cy++) {
+            for (int cx = 0; cx < chunks_x; cx++) {
+                floor.at(cx * ChunkedFloor::CHUNK_SIZE, cy * ChunkedFloor::CHUNK_SIZE);
+                peak_resident = std::max(peak_resident, floor.resident_chunks());
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || ms < best_ms) best_ms = ms;
+    }
+    std::cout << "Generated all " << chunk_count << " chunks of a " << size << "x" << size << " floor in " << best_ms
+              << " ms (" << best_ms * 1000.0 / chunk_count << " us per chunk incl. eviction, best of " << runs
+              << "), peak " << peak_resident << " resident of " << floor.resident_limit() << std::endl;
+    return best_ms;
+}
@@ -0,0 +1,47 @@
+// FrameArena.cpp - Global heap allocation counter
+//
+// Replaces the global operator new so the stress test can report how many heap
+// allocations a steady-state frame makes. The count is a relaxed atomic increment.
+// Only compiled in with SEARCHING_COUNT_ALLOCATIONS (CMake option of the same name),
+// so normal builds keep the toolchain's allocator untouched.
+
+#include "FrameArena.h"
+
+#ifdef SEARCHING_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> g_heap_allocations{0};
+
+size_t heap_allocation_count() {
+    return g_heap_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* ptr = std::malloc(size)) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#else
+
+size_t heap_allocation_count() {
+    return 0;
+}
+
+#endif
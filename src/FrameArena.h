@@ -0,0 +1,105 @@
+// FrameArena.h - Per-frame bump allocator for transient allocations
+//
+// Scratch memory (query results, temporary lists) is bumped out of one buffer and
+// released all at once when Game::run calls frame_arena().reset() at the start of
+// each frame. It is a std::pmr::memory_resource, so standard containers can use it:
+//     std::pmr::vector<Entity> result(&frame_arena());
+// Nothing allocated from it may be kept past the end of the frame.
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Count of global operator new calls since startup (defined in FrameArena.cpp).
+// Always 0 unless built with SEARCHING_COUNT_ALLOCATIONS.
+size_t heap_allocation_count();
+
+#ifdef SEARCHING_COUNT_ALLOCATIONS
+constexpr bool HEAP_ALLOCATIONS_COUNTED = true;
+#else
+constexpr bool HEAP_ALLOCATIONS_COUNTED = false;
+#endif
+
+class FrameArena : public std::pmr::memory_resource {
+private:
+    std::unique_ptr<std::byte[]> buffer;
+    size_t capacity = 0;
+    size_t offset = 0;
+    size_t high_water = 0;
+
+    // Requests that didn't fit; served by the heap and freed on reset
+    struct OverflowBlock {
+        void* ptr;
+        size_t bytes;
+        size_t alignment;
+    };
+    std::vector<OverflowBlock> overflow;
+    size_t overflow_bytes = 0;
+    size_t total_overflow_count = 0;
+
+public:
+    explicit FrameArena(size_t bytes = 1 << 20) : buffer(new std::byte[bytes]), capacity(bytes) {
+        overflow.reserve(64);
+    }
+
+    ~FrameArena() override { reset(); }
+
+    // Frees the whole frame at once; anything from the arena is now dangling
+    void reset() {
+        for (const OverflowBlock& block : overflow) {
+            std::pmr::new_delete_resource()->deallocate(block.ptr, block.bytes, block.alignment);
+        }
+        overflow.clear();
+        overflow_bytes = 0;
+        offset = 0;
+    }
+
+    size_t used() const { return offset; }
+    size_t size() const { return capacity; }
+    size_t peak() const { return high_water; }            // Highest use in any frame
+    size_t overflowed_this_frame() const { return overflow_bytes; }  // Since the last reset()
+    size_t overflow_count() const { return total_overflow_count; }  // Since startup
+
+    void clear_stats() {
+        high_water = offset;
+        overflow_bytes = 0;
+        total_overflow_count = 0;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        // Align the address, not the offset: new[] only guarantees the default
+        // new alignment, so over-aligned requests need the base folded in
+        uintptr_t base = reinterpret_cast<uintptr_t>(buffer.get());
+        uintptr_t address = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        size_t aligned = (size_t)(address - base);
+        if (aligned + bytes <= capacity) {
+            offset = aligned + bytes;
+            if (offset > high_water) high_water = offset;
+            return buffer.get() + aligned;
+        }
+
+        // Out of arena: stay correct, but record it so the budget can be raised
+        void* ptr = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        overflow.push_back({ptr, bytes, alignment});
+        overflow_bytes += bytes;
+        total_overflow_count++;
+        return ptr;
+    }
+
+    // Individual frees are no-ops; reset() reclaims everything
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// One arena per thread, so workers never contend on it
+inline FrameArena& frame_arena() {
+    thread_local FrameArena arena;
+    return arena;
+}
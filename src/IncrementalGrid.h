@@ -0,0 +1,118 @@
+// IncrementalGrid.h - Persistent uniform grid over boxes that move a little per frame
+//
+// SpatialGrid is rebuilt from scratch for every use; this one keeps its entries and
+// re-files a box only when update() is called for it, moving it to another cell only
+// when its top-left corner crosses a cell boundary. A frame therefore costs the boxes
+// that changed plus the cells a query touches. Cells are hashed by (column, row), so
+// there are no arena bounds. As in SpatialGrid, each box lives in one cell and
+// queries widen their search by the largest box size, so nothing is reported twice.
+#pragma once
+
+extern "C" {
+    #include "raylib.h"
+}
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+class IncrementalGrid {
+public:
+    struct Item {
+        int id;
+        Rectangle bounds;
+        uint32_t flags;  // Caller-defined; kept when the box moves, set with set_flags()
+    };
+
+private:
+    struct Location {
+        uint64_t cell;
+        uint32_t slot;   // Index in that cell's item list
+    };
+
+    std::unordered_map<uint64_t, std::vector<Item>> cells;  // Emptied cells keep their storage
+    std::unordered_map<int, Location> locations;
+    float cell_size;
+    float max_w = 0, max_h = 0;  // Largest box ever filed; only grows
+
+    int cell_coord(float v) const { return (int)std::floor(v / cell_size); }
+
+    static uint64_t cell_key(int column, int row) {
+        return ((uint64_t)(uint32_t)row << 32) | (uint32_t)column;
+    }
+
+    void unlink(const Location& location) {
+        std::vector<Item>& items = cells[location.cell];
+        if (location.slot + 1 != items.size()) {
+            items[location.slot] = items.back();
+            locations[items[location.slot].id].slot = location.slot;
+        }
+        items.pop_back();
+    }
+
+public:
+    explicit IncrementalGrid(float cell = 256.0f) : cell_size(cell) {}
+
+    size_t size() const { return locations.size(); }
+
+    // Inserts the box or moves it to its new bounds
+    void update(int id, Rectangle bounds) {
+        max_w = std::max(max_w, bounds.width);
+        max_h = std::max(max_h, bounds.height);
+        uint64_t cell = cell_key(cell_coord(bounds.x), cell_coord(bounds.y));
+
+        uint32_t flags = 0;
+        auto it = locations.find(id);
+        if (it != locations.end()) {
+            Item& item = cells[it->second.cell][it->second.slot];
+            if (it->second.cell == cell) {
+                item.bounds = bounds;
+                return;
+            }
+            flags = item.flags;
+            unlink(it->second);
+        }
+
+        std::vector<Item>& items = cells[cell];
+        locations[id] = {cell, (uint32_t)items.size()};
+        items.push_back({id, bounds, flags});
+    }
+
+    void set_flags(int id, uint32_t flags) {
+        auto it = locations.find(id);
+        if (it != locations.end()) cells[it->second.cell][it->second.slot].flags = flags;
+    }
+
+    void remove(int id) {
+        auto it = locations.find(id);
+        if (it == locations.end()) return;
+        unlink(it->second);
+        locations.erase(it);
+    }
+
+    void clear() {
+        for (auto& [key, items] : cells) items.clear();
+        locations.clear();
+    }
+
+    // Calls fn(const Item&) for every box overlapping area
+    template<typename Fn>
+    void query(Rectangle area, Fn&& fn) const {
+        if (locations.empty()) return;
+
+        // A box filed in an earlier cell can still reach into area by up to its size
+        int c0 = cell_coord(area.x - max_w), c1 = cell_coord(area.x + area.width);
+        int r0 = cell_coord(area.y - max_h), r1 = cell_coord(area.y + area.height);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                auto it = cells.find(cell_key(c, r));
+                if (it == cells.end()) continue;
+                for (const Item& item : it->second) {
+                    if (CheckCollisionRecs(item.bounds, area)) fn(item);
+                }
+            }
+        }
+    }
+};
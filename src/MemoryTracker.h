@@ -0,0 +1,211 @@
+// MemoryTracker.h - Attributes heap usage to named categories
+//
+// Categories are created on first use and live for the whole program, so code can
+// cache a MemoryCategory& in a static. Three ways to feed them:
+//   - TrackingAllocator<T, Tag>: a std allocator for containers (ECS tables)
+//   - TrackedObject: base class whose operator new takes a category and stores it
+//     in a small header, so delete through a base pointer is still attributed
+//   - MemoryCategory::add/remove for memory we don't allocate ourselves (textures)
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+struct MemoryStats {
+    std::string name;
+    int64_t bytes;
+    int64_t peak_bytes;
+    int64_t live_allocations;
+    int64_t total_allocations;
+};
+
+class MemoryCategory {
+private:
+    std::string category_name;
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<int64_t> live{0};
+    std::atomic<int64_t> total{0};
+
+public:
+    explicit MemoryCategory(const std::string& name) : category_name(name) {}
+
+    void add(size_t size) {
+        int64_t now = bytes.fetch_add((int64_t)size) + (int64_t)size;
+        live.fetch_add(1);
+        total.fetch_add(1);
+        int64_t old_peak = peak.load();
+        while (now > old_peak && !peak.compare_exchange_weak(old_peak, now)) {}
+    }
+
+    void remove(size_t size) {
+        bytes.fetch_sub((int64_t)size);
+        live.fetch_sub(1);
+    }
+
+    const std::string& name() const { return category_name; }
+    int64_t current_bytes() const { return bytes.load(); }
+
+    MemoryStats stats() const {
+        return {category_name, bytes.load(), peak.load(), live.load(), total.load()};
+    }
+};
+
+class MemoryTracker {
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MemoryCategory>> categories;
+
+public:
+    static MemoryTracker& instance() {
+        static MemoryTracker tracker;
+        return tracker;
+    }
+
+    // Finds or creates a category; the reference stays valid for the program's lifetime
+    MemoryCategory& category(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& c : categories) {
+            if (c->name() == name) return *c;
+        }
+        categories.push_back(std::make_unique<MemoryCategory>(name));
+        return *categories.back();
+    }
+
+    std::vector<MemoryStats> snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<MemoryStats> result;
+        result.reserve(categories.size());
+        for (auto& c : categories) {
+            result.push_back(c->stats());
+        }
+        std::sort(result.begin(), result.end(), [](const MemoryStats& a, const MemoryStats& b) {
+            return a.name < b.name;
+        });
+        return result;
+    }
+
+    // Sum of every category whose name starts with prefix ("" for everything)
+    int64_t bytes_with_prefix(const std::string& prefix) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t sum = 0;
+        for (auto& c : categories) {
+            if (c->name().compare(0, prefix.size(), prefix) == 0) sum += c->current_bytes();
+        }
+        return sum;
+    }
+
+    // CSV dump; per_unit_divisor > 0 adds a bytes-per-unit column for budgeting
+    bool dump(const std::string& filename, size_t per_unit_divisor = 0) {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            std::cout << "Failed to write memory report: " << filename << std::endl;
+            return false;
+        }
+        file << "category,bytes,peak_bytes,live_allocations,total_allocations,bytes_per_unit" << std::endl;
+        for (const MemoryStats& s : snapshot()) {
+            file << s.name << "," << s.bytes << "," << s.peak_bytes << ","
+                 << s.live_allocations << "," << s.total_allocations << ",";
+            if (per_unit_divisor > 0) file << (double)s.bytes / per_unit_divisor;
+            file << std::endl;
+        }
+        std::cout << "Memory report written to " << filename << std::endl;
+        return true;
+    }
+};
+
+// GCC/Clang typeid names are mangled ("17PositionComponent"), MSVC's are
+// prefixed ("class PositionComponent"); both reduce to the plain class name.
+inline std::string readable_type_name(const char* raw) {
+    std::string name = raw;
+    for (const char* prefix : {"class ", "struct "}) {
+        if (name.compare(0, strlen(prefix), prefix) == 0) name.erase(0, strlen(prefix));
+    }
+    size_t digits = 0;
+    while (digits < name.size() && name[digits] >= '0' && name[digits] <= '9') digits++;
+    return name.substr(digits);
+}
+
+// Stateless std allocator charging every allocation to Tag::name
+template <typename T, typename Tag>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = TrackingAllocator<U, Tag>; };
+
+    TrackingAllocator() noexcept {}
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Tag>&) noexcept {}
+
+    static MemoryCategory& category() {
+        static MemoryCategory& c = MemoryTracker::instance().category(Tag::name);
+        return c;
+    }
+
+    T* allocate(size_t n) {
+        category().add(n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        category().remove(n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, Tag>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+// Objects allocated with `new (category) T(...)` are charged to that category;
+// a plain `new T` goes to "untracked". The header keeps 16-byte alignment.
+class TrackedObject {
+private:
+    struct alignas(16) Header {
+        MemoryCategory* category;
+        size_t size;
+    };
+
+    static MemoryCategory& untracked() {
+        static MemoryCategory& c = MemoryTracker::instance().category("untracked");
+        return c;
+    }
+
+public:
+    static void* operator new(size_t size, MemoryCategory& category) {
+        Header* header = static_cast<Header*>(::operator new(sizeof(Header) + size));
+        header->category = &category;
+        header->size = size;
+        category.add(size);
+        return header + 1;
+    }
+
+    static void* operator new(size_t size) {
+        return operator new(size, untracked());
+    }
+
+    static void operator delete(void* ptr) {
+        if (!ptr) return;
+        Header* header = static_cast<Header*>(ptr) - 1;
+        header->category->remove(header->size);
+        ::operator delete(header);
+    }
+
+    // Matching delete for when a constructor throws during placement new
+    static void operator delete(void* ptr, MemoryCategory&) {
+        operator delete(ptr);
+    }
+};
@@ -12,8 +12,21 @@ extern "C" {
 
 class Popup {
 private:
+    // One laid-out glyph: codepoint, absolute draw position, and its index in fullText
+    struct PlacedGlyph {
+        int codepoint;
+        Vector2 position;
+        int revealIndex;
+    };
+    
+    static constexpr float TEXT_SIZE = 24;
+    static constexpr float TEXT_SPACING = 1.5f;
+    static constexpr float LINE_SPACING = 2;   // Matches raylib's default text line spacing
+    static constexpr float TEXT_PADDING = 20;
+    
     std::string fullText;
-    std::string displayText;
+    int revealCount = 0;     // Characters shown so far by the typewriter
+    int characterCount = 0;  // Codepoints in fullText
     int typingTimer = 0;
     int typingSpeed = 3;  // Frames per character
     bool isTypingComplete = false;
@@ -34,6 +47,12 @@ private:
     // Input blocking - prevent same-frame input processing
     bool justClosed = false;
     
+    // Text layout cache - built once per show() and font, drawn glyph by glyph
+    std::vector<PlacedGlyph> glyphs;
+    bool layoutDirty = true;
+    unsigned int layoutFontId = 0;
+    Vector2 promptSize = {0, 0};
+    
 public:
     bool isActive = false;
     
@@ -41,7 +60,9 @@ public:
     
     void show(const std::string& text, float x, float y, float width, float height) {
         fullText = text;
-        displayText = "";
+        revealCount = 0;
+        characterCount = countCodepoints(text);
+        layoutDirty = true;
         typingTimer = 0;
         scaleTimer = 0;
         isTypingComplete = false;
@@ -89,8 +110,8 @@ public:
             typingTimer++;
             if (typingTimer >= typingSpeed) {
                 typingTimer = 0;
-                if (displayText.length() < fullText.length()) {
-                    displayText += fullText[displayText.length()];
+                if (revealCount < characterCount) {
+                    revealCount++;
                 } else {
                     isTypingComplete = true;
                 }
@@ -99,7 +120,7 @@ public:
         
         // Check for Enter to skip typing
         if (IsKeyPressed(KEY_ENTER) && !isTypingComplete) {
-            displayText = fullText;
+            revealCount = characterCount;
             isTypingComplete = true;
             inputConsumed = true;
         }
@@ -151,6 +172,11 @@ public:
     void draw(Font& font) {
         if (!isActive) return;
         
+        // show() has no font, so wrap on the first draw (or if the font changes)
+        if (layoutDirty || layoutFontId != font.texture.id) {
+            layoutText(font);
+        }
+        
         // Calculate current scale based on animation
         float scale = 1.0f;
         if (!animationComplete) {
@@ -169,10 +195,12 @@ public:
         DrawRectangleLines((int)currentX, (int)currentY, (int)currentWidth, (int)currentHeight, WHITE);
         
         // Draw text (only if animation is complete)
-        if (animationComplete && !displayText.empty()) {
-            float textX = currentX + 20;
-            float textY = currentY + 20;
-            DrawTextEx(font, displayText.c_str(), {textX, textY}, 24, 1.5f, WHITE);
+        // Glyphs are in reveal order, so stop at the first one not typed yet
+        if (animationComplete) {
+            for (const PlacedGlyph& glyph : glyphs) {
+                if (glyph.revealIndex >= revealCount) break;
+                DrawTextCodepoint(font, glyph.codepoint, glyph.position, TEXT_SIZE, WHITE);
+            }
         }
         
         // Draw buttons or continue prompt when typing is complete
@@ -182,10 +210,9 @@ public:
             } else {
                 // Draw continue prompt (>) in bottom right
                 const char* continuePrompt = ">";
-                Vector2 promptSize = MeasureTextEx(font, continuePrompt, 24, 1.5f);
                 float promptX = currentX + currentWidth - promptSize.x - 20;
                 float promptY = currentY + currentHeight - promptSize.y - 10;
-                DrawTextEx(font, continuePrompt, {promptX, promptY}, 24, 1.5f, WHITE);
+                DrawTextEx(font, continuePrompt, {promptX, promptY}, TEXT_SIZE, TEXT_SPACING, WHITE);
             }
         }
     }
@@ -199,6 +226,87 @@ public:
     }
     
 private:
+    static int countCodepoints(const std::string& text) {
+        int count = 0;
+        const char* ptr = text.c_str();
+        while (*ptr) {
+            int size = 0;
+            GetCodepointNext(ptr, &size);
+            ptr += (size > 0) ? size : 1;
+            count++;
+        }
+        return count;
+    }
+    
+    // Same advance DrawTextEx uses, so wrapped text lines up with the old rendering
+    static float glyphAdvance(const Font& font, int codepoint) {
+        int index = GetGlyphIndex(font, codepoint);
+        float advance = (font.glyphs[index].advanceX != 0) ? (float)font.glyphs[index].advanceX : font.recs[index].width;
+        return advance * (TEXT_SIZE / font.baseSize) + TEXT_SPACING;
+    }
+    
+    // Word-wraps fullText to the box width and stores every visible glyph's position
+    void layoutText(const Font& font) {
+        glyphs.clear();
+        glyphs.reserve(characterCount);
+        
+        float originX = targetX + TEXT_PADDING;
+        float maxWidth = targetWidth - TEXT_PADDING * 2;
+        float x = 0;
+        float y = targetY + TEXT_PADDING;
+        float spaceWidth = glyphAdvance(font, ' ');
+        
+        const char* ptr = fullText.c_str();
+        int index = 0;
+        while (*ptr) {
+            int size = 0;
+            int codepoint = GetCodepointNext(ptr, &size);
+            if (size <= 0) size = 1;
+            
+            if (codepoint == '\n') {
+                x = 0;
+                y += TEXT_SIZE + LINE_SPACING;
+                ptr += size;
+                index++;
+                continue;
+            }
+            if (codepoint == ' ') {
+                x += spaceWidth;
+                ptr += size;
+                index++;
+                continue;
+            }
+            
+            // Measure the whole word first so it moves to the next line as a unit
+            float wordWidth = 0;
+            const char* end = ptr;
+            while (*end) {
+                int wordSize = 0;
+                int wordCodepoint = GetCodepointNext(end, &wordSize);
+                if (wordCodepoint == ' ' || wordCodepoint == '\n') break;
+                wordWidth += glyphAdvance(font, wordCodepoint);
+                end += (wordSize > 0) ? wordSize : 1;
+            }
+            if (x > 0 && x + wordWidth > maxWidth) {
+                x = 0;
+                y += TEXT_SIZE + LINE_SPACING;
+            }
+            
+            while (ptr < end) {
+                int glyphSize = 0;
+                int glyphCodepoint = GetCodepointNext(ptr, &glyphSize);
+                glyphs.push_back({glyphCodepoint, {originX + x, y}, index});
+                x += glyphAdvance(font, glyphCodepoint);
+                ptr += (glyphSize > 0) ? glyphSize : 1;
+                index++;
+            }
+        }
+        
+        promptSize = MeasureTextEx(font, ">", TEXT_SIZE, TEXT_SPACING);
+        layoutFontId = font.texture.id;
+        layoutDirty = false;
+    }
+    
     void drawButtons(Font& font, float textBoxX, float textBoxY, float textBoxWidth, float textBoxHeight) {
         if (buttons.size() == 2) {
             // Yes/No style - side by side in choice box next to text box
@@ -0,0 +1,216 @@
+// Random.h - Seedable, per-subsystem random number streams
+//
+// Each subsystem draws from its own xoshiro128++ stream, so dungeon layouts don't
+// shift because a battle rolled more numbers. Streams are plain values with no
+// shared state: a parallel worker forks its own copy and never contends.
+// Bounded draws use Lemire's method rather than std distributions, whose output
+// differs between standard libraries, so a seed reproduces on every platform.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+// splitmix64 - expands one 64-bit seed into well-mixed stream states
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class Xoshiro128pp {
+public:
+    using result_type = uint32_t;
+    uint32_t s[4];
+
+    explicit Xoshiro128pp(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        uint64_t sm = seed;
+        uint64_t a = splitmix64(sm);
+        uint64_t b = splitmix64(sm);
+        s[0] = (uint32_t)a;
+        s[1] = (uint32_t)(a >> 32);
+        s[2] = (uint32_t)b;
+        s[3] = (uint32_t)(b >> 32);
+        if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;  // All-zero state is invalid
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    uint32_t operator()() { return next_u32(); }
+
+    uint32_t next_u32() {
+        const uint32_t result = rotl(s[0] + s[3], 7) + s[0];
+        const uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    uint64_t next_u64() {
+        uint64_t high = next_u32();
+        return (high << 32) | next_u32();
+    }
+
+    // Uniform integer in [0, bound)
+    uint32_t below(uint32_t bound) {
+        if (bound == 0) return 0;
+        uint64_t m = (uint64_t)next_u32() * bound;
+        uint32_t low = (uint32_t)m;
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                m = (uint64_t)next_u32() * bound;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // Uniform integer in [lo, hi]
+    int range(int lo, int hi) {
+        if (hi <= lo) return lo;
+        return lo + (int)below((uint32_t)(hi - lo) + 1u);
+    }
+
+    // Uniform float in [0, 1)
+    float next_float() {
+        return (next_u32() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float range_float(float lo, float hi) {
+        return lo + (hi - lo) * next_float();
+    }
+
+    // Advance 2^64 draws - used to hand non-overlapping subsequences to workers
+    void jump() {
+        static const uint32_t JUMP[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+        uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (uint32_t word : JUMP) {
+            for (int b = 0; b < 32; b++) {
+                if (word & (1u << b)) {
+                    s0 ^= s[0];
+                    s1 ^= s[1];
+                    s2 ^= s[2];
+                    s3 ^= s[3];
+                }
+                next_u32();
+            }
+        }
+        s[0] = s0;
+        s[1] = s1;
+        s[2] = s2;
+        s[3] = s3;
+    }
+
+private:
+    static uint32_t rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+};
+
+// Named streams - append new ones at the end so saved states stay valid
+enum RngStreamId {
+    RNG_DUNGEON,
+    RNG_SPAWN,
+    RNG_COMBAT,  // Reserved: combat is deterministic today, draw from this once it isn't
+    RNG_STREAM_COUNT
+};
+
+inline const char* rng_stream_name(int id) {
+    static const char* names[RNG_STREAM_COUNT] = { "dungeon", "spawn", "combat" };
+    return (id >= 0 && id < RNG_STREAM_COUNT) ? names[id] : "unknown";
+}
+
+class RngService {
+private:
+    uint64_t master_seed = 0;
+    Xoshiro128pp streams[RNG_STREAM_COUNT];
+
+public:
+    explicit RngService(uint64_t seed = 0) { seed_all(seed); }
+
+    // Every stream gets an independent seed derived from the master seed
+    void seed_all(uint64_t seed) {
+        master_seed = seed;
+        uint64_t sm = seed;
+        for (auto& stream : streams) {
+            stream.reseed(splitmix64(sm));
+        }
+    }
+
+    uint64_t get_master_seed() const { return master_seed; }
+
+    Xoshiro128pp& stream(RngStreamId id) { return streams[id]; }
+
+    // Private copy of a stream for parallel worker `worker`, jumped 2^64 draws per
+    // index so workers never overlap. The service itself is left untouched.
+    Xoshiro128pp fork(RngStreamId id, int worker) const {
+        Xoshiro128pp copy = streams[id];
+        for (int i = 0; i <= worker; i++) {
+            copy.jump();
+        }
+        return copy;
+    }
+
+    // Saves the master seed and current position of every stream
+    bool save(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file.is_open()) return false;
+        file << "master," << master_seed << std::endl;
+        for (int i = 0; i < RNG_STREAM_COUNT; i++) {
+            const Xoshiro128pp& st = streams[i];
+            file << rng_stream_name(i) << "," << st.s[0] << "," << st.s[1] << "," << st.s[2] << "," << st.s[3] << std::endl;
+        }
+        return true;
+    }
+
+    // False if the file is missing, has no master seed, or holds a number that does
+    // not parse; streams may then be partly loaded, so the caller should reseed
+    bool load(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) return false;
+
+        std::string line;
+        bool has_master = false;
+        try {
+            while (std::getline(file, line)) {
+                std::istringstream ss(line);
+                std::string name, value;
+                if (!std::getline(ss, name, ',')) continue;
+
+                if (name == "master" && std::getline(ss, value)) {
+                    seed_all(std::stoull(value));
+                    has_master = true;
+                    continue;
+                }
+                for (int i = 0; i < RNG_STREAM_COUNT; i++) {
+                    if (name != rng_stream_name(i)) continue;
+                    uint32_t state[4];
+                    int parsed = 0;
+                    while (parsed < 4 && std::getline(ss, value, ',')) {
+                        state[parsed++] = (uint32_t)std::stoul(value);
+                    }
+                    if (parsed == 4 && (state[0] | state[1] | state[2] | state[3]) != 0) {
+                        for (int k = 0; k < 4; k++) streams[i].s[k] = state[k];
+                    }
+                }
+            }
+        } catch (const std::invalid_argument&) {
+            return false;
+        } catch (const std::out_of_range&) {
+            return false;
+        }
+        return has_master;
+    }
+};
@@ -0,0 +1,61 @@
+// RetainedLayer.h - Static scene content cached in a render texture
+//
+// Scenes draw content that rarely changes (menus, the dungeon grid) into the layer
+// once, mark it dirty when their state changes, and every other frame composite it
+// with a single textured quad. Frame cost no longer depends on how much is drawn.
+#pragma once
+
+extern "C" {
+    #include "raylib.h"
+}
+
+class RetainedLayer {
+private:
+    RenderTexture2D target = {};
+    int width = 0;
+    int height = 0;
+    bool dirty = true;
+
+public:
+    RetainedLayer() {}
+    ~RetainedLayer() { unload(); }
+
+    // Owns a GPU texture - not copyable
+    RetainedLayer(const RetainedLayer&) = delete;
+    RetainedLayer& operator=(const RetainedLayer&) = delete;
+
+    void markDirty() { dirty = true; }
+    bool isDirty() const { return dirty; }
+
+    // Re-renders through `render` only when dirty, then composites at (x, y).
+    // `render` draws in layer coordinates, with the layer cleared to transparent.
+    template <typename RenderFn>
+    void draw(int layerWidth, int layerHeight, RenderFn&& render, float x = 0, float y = 0) {
+        if (target.id == 0 || width != layerWidth || height != layerHeight) {
+            unload();
+            target = LoadRenderTexture(layerWidth, layerHeight);
+            width = layerWidth;
+            height = layerHeight;
+            dirty = true;
+        }
+
+        if (dirty) {
+            BeginTextureMode(target);
+            ClearBackground(BLANK);
+            render();
+            EndTextureMode();
+            dirty = false;
+        }
+
+        // Render textures are stored bottom-up, so flip the source rect
+        Rectangle source = {0, 0, (float)width, -(float)height};
+        DrawTextureRec(target.texture, source, {x, y}, WHITE);
+    }
+
+    void unload() {
+        if (target.id != 0) {
+            UnloadRenderTexture(target);
+            target = {};
+        }
+    }
+};
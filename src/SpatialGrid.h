@@ -0,0 +1,112 @@
+// SpatialGrid.h - Uniform grid over axis-aligned boxes, rebuilt every frame
+//
+// Usage per frame: clear(), add() every box, build(), then any number of query()
+// calls. Each box is filed only in the cell holding its top-left corner, and
+// queries widen their search by the largest box size, so nothing is reported twice.
+// build() is a counting sort into flat arrays; nothing allocates once the
+// arrays have grown to the peak population.
+#pragma once
+
+extern "C" {
+    #include "raylib.h"
+}
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+class SpatialGrid {
+public:
+    struct Item {
+        int id;
+        Rectangle bounds;
+    };
+
+private:
+    static const int MAX_AXIS_CELLS = 256;  // Huge arenas get bigger cells instead of more
+
+    std::vector<Item> items;       // As added
+    std::vector<Item> sorted;      // Grouped by cell
+    std::vector<uint32_t> cell_start;
+    std::vector<uint32_t> fill;    // Build scratch
+    float base_cell_size;
+    float cell_size;
+    float origin_x = 0, origin_y = 0;
+    int cols = 0, rows = 0;
+    float max_w = 0, max_h = 0;
+
+    int column(float x) const { return std::clamp((int)std::floor((x - origin_x) / cell_size), 0, cols - 1); }
+    int row(float y) const { return std::clamp((int)std::floor((y - origin_y) / cell_size), 0, rows - 1); }
+
+public:
+    explicit SpatialGrid(float cell = 128.0f) : base_cell_size(cell), cell_size(cell) {}
+
+    size_t size() const { return sorted.size(); }
+
+    void clear() { items.clear(); }
+
+    void add(int id, Rectangle bounds) { items.push_back({id, bounds}); }
+
+    void build() {
+        sorted.clear();
+        cols = rows = 0;
+        if (items.empty()) return;
+
+        float min_x = items[0].bounds.x, min_y = items[0].bounds.y;
+        float max_x = min_x, max_y = min_y;
+        max_w = max_h = 0;
+        for (const Item& item : items) {
+            min_x = std::min(min_x, item.bounds.x);
+            min_y = std::min(min_y, item.bounds.y);
+            max_x = std::max(max_x, item.bounds.x);
+            max_y = std::max(max_y, item.bounds.y);
+            max_w = std::max(max_w, item.bounds.width);
+            max_h = std::max(max_h, item.bounds.height);
+        }
+
+        origin_x = min_x;
+        origin_y = min_y;
+        cell_size = std::max(base_cell_size, std::max(max_x - min_x, max_y - min_y) / MAX_AXIS_CELLS);
+        cols = (int)((max_x - min_x) / cell_size) + 1;
+        rows = (int)((max_y - min_y) / cell_size) + 1;
+
+        // Count per cell, prefix-sum into start offsets, then scatter
+        cell_start.assign((size_t)cols * rows + 1, 0);
+        for (const Item& item : items) {
+            cell_start[cell_of(item) + 1]++;
+        }
+        for (size_t c = 1; c < cell_start.size(); c++) {
+            cell_start[c] += cell_start[c - 1];
+        }
+        fill.assign(cell_start.begin(), cell_start.end() - 1);
+        sorted.resize(items.size());
+        for (const Item& item : items) {
+            sorted[fill[cell_of(item)]++] = item;
+        }
+    }
+
+    // Calls fn(const Item&) for every box overlapping area
+    template<typename Fn>
+    void query(Rectangle area, Fn&& fn) const {
+        if (cols == 0) return;
+        if (area.x + area.width < origin_x || area.y + area.height < origin_y) return;
+
+        // A box filed in an earlier cell can still reach into area by up to its size
+        int c0 = column(area.x - max_w), c1 = column(area.x + area.width);
+        int r0 = row(area.y - max_h), r1 = row(area.y + area.height);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                size_t cell = (size_t)r * cols + c;
+                for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+                    if (CheckCollisionRecs(sorted[i].bounds, area)) fn(sorted[i]);
+                }
+            }
+        }
+    }
+
+private:
+    size_t cell_of(const Item& item) const {
+        return (size_t)row(item.bounds.y) * cols + column(item.bounds.x);
+    }
+};
@@ -0,0 +1,89 @@
+// ThreadPool.h - Fixed set of worker threads pulling jobs from one queue
+//
+// Used for CPU-only work that can run off the main thread (image decoding).
+// Anything touching the GL context must stay on the main thread.
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable all_done;
+    int busy = 0;
+    bool stopping = false;
+
+public:
+    // 0 threads means one per hardware thread, leaving one for the main thread
+    explicit ThreadPool(unsigned int thread_count = 0) {
+        if (thread_count == 0) {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            thread_count = (hardware > 1) ? hardware - 1 : 1;
+        }
+        workers.reserve(thread_count);
+        for (unsigned int i = 0; i < thread_count; i++) {
+            workers.emplace_back([this]() { worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_ready.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        work_ready.notify_one();
+    }
+
+    // Blocks until the queue is empty and no job is running
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        all_done.wait(lock, [this]() { return jobs.empty() && busy == 0; });
+    }
+
+private:
+    void worker_loop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                busy++;
+            }
+
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+                if (jobs.empty() && busy == 0) all_done.notify_all();
+            }
+        }
+    }
+};
@@ -0,0 +1,194 @@
+// TimerWheel.h - Hierarchical timing wheel for frame-based timers
+//
+// Systems schedule an event `delay` ticks ahead instead of counting a timer down
+// on every entity every frame. advance() costs one slot per tick plus the timers
+// that actually expire (and an occasional cascade), not the number of pending timers.
+//
+// Four levels of 64 slots: level 0 holds timers due within 64 ticks, level 1 within
+// 64^2, and so on. When a lower level wraps, the matching slot of the next level
+// is redistributed downwards. Delays past 64^4 ticks park in the top level and are
+// re-filed each time they cascade.
+//
+// Payload is a small copyable event (what to do, to whom); the owner of the wheel
+// dispatches it in the advance() callback, which may schedule new timers.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct TimerHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != UINT32_MAX; }
+};
+
+template<typename Payload>
+class TimerWheel {
+private:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4;
+    static const uint32_t NIL = UINT32_MAX;
+    static const uint64_t MAX_DELTA = (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+    // Pooled nodes, linked into buckets by index so scheduling never allocates
+    // once the pool has grown to the peak number of pending timers
+    struct Node {
+        uint64_t expiry;
+        Payload payload;
+        uint32_t prev, next;
+        uint32_t generation;
+        int32_t bucket;      // level * SLOTS + slot, FREE or FIRING
+    };
+    static const int32_t FREE = -1;
+    static const int32_t FIRING = -2;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> free_nodes;
+    std::vector<uint32_t> firing;   // Scratch for advance()
+    uint32_t heads[LEVELS * SLOTS];
+    uint64_t current = 0;    // Last tick processed
+    size_t pending = 0;
+
+public:
+    TimerWheel() { clear(); }
+
+    uint64_t now() const { return current; }
+    size_t size() const { return pending; }
+
+    // Grows the pool up front, so nothing allocates until more than `count` timers
+    // are pending at once
+    void reserve(size_t count) {
+        if (nodes.capacity() >= count) return;
+        count = std::max(count, nodes.capacity() * 2);
+        nodes.reserve(count);
+        free_nodes.reserve(count);
+        firing.reserve(count);
+    }
+
+    // Fires on the tick `delay` from now; a delay of 0 fires on the next tick
+    TimerHandle schedule(uint64_t delay, const Payload& payload) {
+        uint32_t index;
+        if (!free_nodes.empty()) {
+            index = free_nodes.back();
+            free_nodes.pop_back();
+        } else {
+            index = (uint32_t)nodes.size();
+            nodes.push_back(Node{});
+        }
+
+        Node& node = nodes[index];
+        node.expiry = current + (delay > 0 ? delay : 1);
+        node.payload = payload;
+        insert(index);
+        pending++;
+        return {index, node.generation};
+    }
+
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(TimerHandle handle) {
+        if (!is_pending(handle)) return false;
+        unlink(handle.index);
+        release(handle.index);
+        return true;
+    }
+
+    bool is_pending(TimerHandle handle) const {
+        return handle.index < nodes.size() && nodes[handle.index].generation == handle.generation &&
+               nodes[handle.index].bucket >= 0;
+    }
+
+    // Moves time forward one tick and calls on_expire(payload) for every timer due on it
+    template<typename Fn>
+    void advance(Fn&& on_expire) {
+        current++;
+
+        // Each level's slot index wraps to 0 when the level below has gone all the way round
+        for (int level = 1; level < LEVELS; level++) {
+            if ((current & ((1ull << (SLOT_BITS * level)) - 1)) != 0) break;
+            cascade(level, (int)((current >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        // Detach the due timers before any callback runs, so callbacks can freely
+        // schedule or cancel (a timer firing this tick can no longer be cancelled)
+        firing.clear();
+        uint32_t& head = heads[current & (SLOTS - 1)];
+        uint32_t index = head;
+        head = NIL;
+        while (index != NIL) {
+            uint32_t next = nodes[index].next;
+            if (nodes[index].expiry <= current) {
+                nodes[index].bucket = FIRING;
+                firing.push_back(index);
+            } else {
+                insert(index);  // Parked overflow timer, not due yet
+            }
+            index = next;
+        }
+
+        for (uint32_t due : firing) {
+            Payload payload = nodes[due].payload;
+            release(due);
+            on_expire(payload);
+        }
+    }
+
+    // Drops every pending timer; keeps the pool for reuse
+    void clear() {
+        for (uint32_t& head : heads) head = NIL;
+        free_nodes.clear();
+        for (uint32_t i = 0; i < (uint32_t)nodes.size(); i++) {
+            if (nodes[i].bucket != FREE) nodes[i].generation++;
+            nodes[i].bucket = FREE;
+            free_nodes.push_back(i);
+        }
+        pending = 0;
+    }
+
+private:
+    void insert(uint32_t index) {
+        Node& node = nodes[index];
+        uint64_t delta = node.expiry - current;
+        uint64_t filed = delta > MAX_DELTA ? current + MAX_DELTA : node.expiry;
+
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1)))) level++;
+        int slot = (int)((filed >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+        int bucket = level * SLOTS + slot;
+        node.bucket = bucket;
+        node.prev = NIL;
+        node.next = heads[bucket];
+        if (node.next != NIL) nodes[node.next].prev = index;
+        heads[bucket] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes[index];
+        if (node.prev != NIL) nodes[node.prev].next = node.next;
+        else heads[node.bucket] = node.next;
+        if (node.next != NIL) nodes[node.next].prev = node.prev;
+    }
+
+    void release(uint32_t index) {
+        nodes[index].bucket = FREE;
+        nodes[index].generation++;
+        free_nodes.push_back(index);
+        pending--;
+    }
+
+    // Re-files one higher-level slot; its timers are now close enough for lower levels
+    void cascade(int level, int slot) {
+        uint32_t& head = heads[level * SLOTS + slot];
+        uint32_t index = head;
+        head = NIL;
+        while (index != NIL) {
+            uint32_t next = nodes[index].next;
+            insert(index);
+            index = next;
+        }
+    }
+};
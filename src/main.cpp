@@ -16,6 +16,8 @@ extern "C" {
 #include <sstream>
 #include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 // Include Popup implementation
 #include "Popup.cpp"
@@ -23,6 +25,15 @@ extern "C" {
 // Include BattleSystem with ECS architecture
 #include "BattleSystem.h"
 
+// Procedural floor generation
+#include "DungeonGenerator.h"
+
+// Render-texture cache for static scene content
+#include "RetainedLayer.h"
+
+// Per-frame scratch allocator
+#include "FrameArena.h"
+
 // Forward declarations
 class Scene;
 class Popup;
@@ -64,6 +75,8 @@ private:
 public:
     Font gameFont;  // Global font for all text
     Popup popup;    // Universal popup system
+    bool stressTest = false;  // --stress: go straight to battle and run the stress test
+    RngService rng;           // Named random streams, saved with the rest of temp_data
     
     Game() {
         InitWindow(screenWidth, screenHeight, "Searching");
@@ -76,6 +89,24 @@ public:
             // Fallback to default font if loading fails
             gameFont = GetFontDefault();
         }
+        
+        // Resume the saved streams so a run can be replayed; new games pick a seed once
+        if (!rng.load(RNG_SAVE_FILE)) {
+            std::cerr << "Warning: no usable RNG state in " << RNG_SAVE_FILE << ", seeding from the clock" << std::endl;
+            seedRandom((uint64_t)time(nullptr));
+        }
+    }
+    
+    static constexpr const char* RNG_SAVE_FILE = "data/temp_data/rng_seeds.txt";
+    
+    void seedRandom(uint64_t seed) {
+        rng.seed_all(seed);
+        saveRandomState();
+        std::cout << "Game seed " << seed << std::endl;
+    }
+    
+    void saveRandomState() {
+        rng.save(RNG_SAVE_FILE);
     }
     
     ~Game() {
@@ -100,9 +131,15 @@ public:
     void run() {
         // Initialize first scene (TEMPORARY: Battle for debugging)
         // switchToBattle();  // Skip to battle for sprite alignment debugging
-        switchToMainMenu();
+        if (stressTest) {
+            SetTargetFPS(0);  // Uncapped, so the report's frame times aren't floored at 16.7 ms
+            switchToBattle();
+        } else {
+            switchToMainMenu();
+        }
         
         while (!WindowShouldClose() && running) {
+            frame_arena().reset();  // Last frame's scratch allocations are dead now
             update();
             draw();
         }
@@ -162,18 +199,24 @@ private:
     int selectedButton = 0;
     const char* buttons[5] = {"PLAY", "LOAD", "SAVE", "EXIT", "TEST POPUP"};
     
+    // Menu text only changes with the selection, so it is drawn once per change
+    RetainedLayer menuLayer;
+    
 public:
     void onEnter() override {
         selectedButton = 0;
+        menuLayer.markDirty();
     }
     
     void update() override {
         // Handle input
         if (IsKeyPressed(KEY_UP)) {
             selectedButton = (selectedButton - 1 + 5) % 5;
+            menuLayer.markDirty();
         }
         if (IsKeyPressed(KEY_DOWN)) {
             selectedButton = (selectedButton + 1) % 5;
+            menuLayer.markDirty();
         }
         
         if (IsKeyPressed(KEY_ENTER)) {
@@ -182,6 +225,11 @@ public:
     }
     
     void draw() override {
+        menuLayer.draw(1280, 720, [this]() { drawMenuText(); });
+    }
+    
+private:
+    void drawMenuText() {
         // Draw title - centered
         const char* title = "searching...";
         Vector2 titleSize = MeasureTextEx(game->gameFont, title, 60, 3);
@@ -206,7 +254,6 @@ public:
         DrawTextEx(game->gameFont, instructions, {instructionsX, 650.0f}, 24, 1.5f, gray);
     }
     
-private:
     void handleButtonPress() {
         switch (selectedButton) {
             case 0: // PLAY
@@ -234,6 +281,9 @@ private:
 // Dungeon exploration scene implementation
 class DungeonScene : public Scene {
 private:
+    // Floor generation settings (size, room ratios, boss count)
+    FloorParams floorParams;
+    
     // Game state
     int x_pos = 2;  // Start in center of 5x5 grid (0-4)
     int y_pos = 2;
@@ -252,24 +302,20 @@ private:
     DungeonState currentState = STATE_MOVEMENT;
     bool stateChange = true;  // Trigger state setup on first frame
     
-    // Room types
-    enum RoomType {
-        ROOM_CLEAR,
-        ROOM_TREASURE,
-        ROOM_ENEMY,
-        ROOM_BOSS,
-        ROOM_WALL  // Out of bounds
-    };
-    
-    // Grid layout constants
-    static const int GRID_SIZE = 5;
+    // Grid layout constants - a VIEW_SIZE x VIEW_SIZE window of the floor is shown
+    static const int VIEW_SIZE = 5;
     static const int GRID_START_X = 390;  // Center the 5x5 grid in 1280px width
     static const int GRID_START_Y = 200;
     static const int CELL_SIZE = 100;
     static const int CELL_SPACING = 10;
     
-    // Room data storage - [x][y] format
-    RoomType roomData[GRID_SIZE][GRID_SIZE];
+    // Room data - chunked, generated lazily, only changed chunks saved
+    ChunkedFloor floorMap;
+    
+    // Header text and grid, redrawn only when the floor, a room or the view changes
+    RetainedLayer gridLayer;
+    int layerOriginX = -1;
+    int layerOriginY = -1;
     
 public:
     void onEnter() override {
@@ -281,59 +327,27 @@ public:
     }
     
     void generateRoomsForFloor() {
-        // Initialize all rooms as enemy rooms
-        for (int x = 0; x < GRID_SIZE; x++) {
-            for (int y = 0; y < GRID_SIZE; y++) {
-                roomData[x][y] = ROOM_ENEMY;
-            }
-        }
+        floorParams.seed = game->rng.stream(RNG_DUNGEON).next_u32();
+        game->saveRandomState();
         
-        // Set center room (2,2) as clear (starting room)
-        roomData[2][2] = ROOM_CLEAR;
-        
-        // Place 1 boss room randomly (not in center)
-        std::vector<std::pair<int,int>> availableSpots;
-        for (int x = 0; x < GRID_SIZE; x++) {
-            for (int y = 0; y < GRID_SIZE; y++) {
-                if (!(x == 2 && y == 2)) { // Not center
-                    availableSpots.push_back({x, y});
-                }
-            }
-        }
-        
-        // Seed random number generator with current time
-        srand(time(nullptr));
-        
-        // Place boss room
-        int bossIndex = rand() % availableSpots.size();
-        int bossX = availableSpots[bossIndex].first;
-        int bossY = availableSpots[bossIndex].second;
-        roomData[bossX][bossY] = ROOM_BOSS;
-        availableSpots.erase(availableSpots.begin() + bossIndex);
-        
-        // Place 3 treasure rooms
-        for (int i = 0; i < 3; i++) {
-            int treasureIndex = rand() % availableSpots.size();
-            int treasureX = availableSpots[treasureIndex].first;
-            int treasureY = availableSpots[treasureIndex].second;
-            roomData[treasureX][treasureY] = ROOM_TREASURE;
-            availableSpots.erase(availableSpots.begin() + treasureIndex);
-        }
-        
-        // Remaining rooms stay as ROOM_ENEMY
+        // Chunks are generated on first visit, so this only sets up the floor
+        floorMap.reset(floorParams, floor);
+        gridLayer.markDirty();
+        std::cout << "New " << floorParams.width << "x" << floorParams.height
+                  << " floor, seed " << floorParams.seed << std::endl;
     }
     
     void saveRoomsToFile() {
         std::string filename = "data/temp_data/rooms.txt";
         std::ofstream file(filename);
         if (file.is_open()) {
-            // Write floor number first
+            // Floor number, then the generation parameters needed to regenerate it
             file << floor << std::endl;
-            // Write room data in format: x,y,roomtype
-            for (int x = 0; x < GRID_SIZE; x++) {
-                for (int y = 0; y < GRID_SIZE; y++) {
-                    file << x << "," << y << "," << (int)roomData[x][y] << std::endl;
-                }
+            const FloorParams& params = floorMap.get_params();
+            file << "params," << params.width << "," << params.height << "," << params.seed << std::endl;
+            // Chunks the player has changed, stored in data/temp_data/floor_chunks
+            for (uint64_t key : floorMap.modified_chunks()) {
+                file << "chunk," << ChunkedFloor::key_x(key) << "," << ChunkedFloor::key_y(key) << std::endl;
             }
             file.close();
         }
@@ -358,24 +372,37 @@ public:
         std::string line;
         std::getline(file, line); // consume newline after floor number
         
+        bool hasParams = false;
+        FloorParams params = floorParams;
+        std::vector<uint64_t> modifiedChunks;
+        
         while (std::getline(file, line)) {
             std::istringstream ss(line);
-            std::string xStr, yStr, roomTypeStr;
+            std::string tag, a, b, c;
             
-            if (std::getline(ss, xStr, ',') && 
-                std::getline(ss, yStr, ',') && 
-                std::getline(ss, roomTypeStr)) {
-                
-                int x = std::stoi(xStr);
-                int y = std::stoi(yStr);
-                int roomType = std::stoi(roomTypeStr);
-                
-                if (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE) {
-                    roomData[x][y] = (RoomType)roomType;
-                }
+            if (!std::getline(ss, tag, ',') || !std::getline(ss, a, ',') || !std::getline(ss, b, ',')) {
+                continue;
+            }
+            
+            if (tag == "params" && std::getline(ss, c)) {
+                params.width = std::stoi(a);
+                params.height = std::stoi(b);
+                params.seed = (uint32_t)std::stoul(c);
+                hasParams = true;
+            } else if (tag == "chunk") {
+                modifiedChunks.push_back(ChunkedFloor::make_key(std::stoi(a), std::stoi(b)));
             }
         }
         file.close();
+        
+        // Old full-grid saves have no params line - regenerate
+        if (!hasParams) {
+            return false;
+        }
+        
+        floorParams = params;
+        floorMap.reset(floorParams, floor, modifiedChunks);
+        gridLayer.markDirty();
         return true;
     }
     
@@ -387,8 +414,9 @@ public:
     }
     
     void markRoomAsCompleted(int x, int y) {
-        if (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE) {
-            roomData[x][y] = ROOM_CLEAR;
+        if (floorMap.in_bounds(x, y)) {
+            floorMap.set(x, y, ROOM_CLEAR);
+            gridLayer.markDirty();
             saveRoomsToFile();
         }
     }
@@ -407,9 +435,22 @@ public:
     }
     
     void draw() override {
+        // The visible window follows the player, so moving it changes the grid
+        if (viewOriginX() != layerOriginX || viewOriginY() != layerOriginY) {
+            layerOriginX = viewOriginX();
+            layerOriginY = viewOriginY();
+            gridLayer.markDirty();
+        }
+        gridLayer.draw(1280, 720, [this]() { drawStaticLayer(); });
+        
+        // Draw player position indicator
+        drawPlayerIndicator();
+    }
+    
+private:
+    void drawStaticLayer() {
         // Define colors at the top of the function
         Color white; white.r = 255; white.g = 255; white.b = 255; white.a = 255;
-        Color black; black.r = 0; black.g = 0; black.b = 0; black.a = 255;
         
         // Draw floor number at top middle
         std::string floorText = "Floor " + std::to_string(floor);
@@ -426,12 +467,8 @@ public:
         
         // Draw 5x5 grid
         drawGrid();
-        
-        // Draw player position indicator
-        drawPlayerIndicator();
     }
     
-private:
     void setupCurrentState() {
         switch (currentState) {
             case STATE_MOVEMENT:
@@ -572,13 +609,17 @@ private:
     }
     
     RoomType identifyRoom(int x, int y) {
-        // Check bounds
-        if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE) {
-            return ROOM_WALL;
-        }
-        
-        // Return room type from generated room data
-        return roomData[x][y];
+        // Out of bounds rooms come back as ROOM_WALL
+        return floorMap.at(x, y);
+    }
+    
+    // Top-left floor cell of the visible window, kept around the player
+    int viewOriginX() const {
+        return std::max(0, std::min(x_pos - VIEW_SIZE / 2, floorMap.width() - VIEW_SIZE));
+    }
+    
+    int viewOriginY() const {
+        return std::max(0, std::min(y_pos - VIEW_SIZE / 2, floorMap.height() - VIEW_SIZE));
     }
     
     void drawGrid() {
@@ -586,9 +627,13 @@ private:
         Color black; black.r = 0; black.g = 0; black.b = 0; black.a = 255;
         Color white; white.r = 255; white.g = 255; white.b = 255; white.a = 255;
         
-        // Draw 5x5 grid with black squares, white borders, connected by white lines
-        for (int y = 0; y < GRID_SIZE; y++) {
-            for (int x = 0; x < GRID_SIZE; x++) {
+        // Only the visible window is drawn, so cost doesn't grow with floor size
+        int cols = std::min(VIEW_SIZE, floorMap.width());
+        int rows = std::min(VIEW_SIZE, floorMap.height());
+        
+        // Draw grid with black squares, white borders, connected by white lines
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) {
                 int cellX = GRID_START_X + x * (CELL_SIZE + CELL_SPACING);
                 int cellY = GRID_START_Y + y * (CELL_SIZE + CELL_SPACING);
                 
@@ -600,8 +645,8 @@ private:
         
         // Draw connecting lines between cells
         // Horizontal lines
-        for (int y = 0; y < GRID_SIZE; y++) {
-            for (int x = 0; x < GRID_SIZE - 1; x++) {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols - 1; x++) {
                 int startX = GRID_START_X + x * (CELL_SIZE + CELL_SPACING) + CELL_SIZE;
                 int endX = GRID_START_X + (x + 1) * (CELL_SIZE + CELL_SPACING);
                 int lineY = GRID_START_Y + y * (CELL_SIZE + CELL_SPACING) + CELL_SIZE / 2;
@@ -610,8 +655,8 @@ private:
         }
         
         // Vertical lines
-        for (int y = 0; y < GRID_SIZE - 1; y++) {
-            for (int x = 0; x < GRID_SIZE; x++) {
+        for (int y = 0; y < rows - 1; y++) {
+            for (int x = 0; x < cols; x++) {
                 int lineX = GRID_START_X + x * (CELL_SIZE + CELL_SPACING) + CELL_SIZE / 2;
                 int startY = GRID_START_Y + y * (CELL_SIZE + CELL_SPACING) + CELL_SIZE;
                 int endY = GRID_START_Y + (y + 1) * (CELL_SIZE + CELL_SPACING);
@@ -624,9 +669,9 @@ private:
         // Define color locally
         Color green; green.r = 0; green.g = 255; green.b = 0; green.a = 255;
         
-        // Draw small green box to indicate player position
-        int playerX = GRID_START_X + x_pos * (CELL_SIZE + CELL_SPACING) + CELL_SIZE / 2 - 10;
-        int playerY = GRID_START_Y + y_pos * (CELL_SIZE + CELL_SPACING) + CELL_SIZE / 2 - 10;
+        // Draw small green box to indicate player position within the visible window
+        int playerX = GRID_START_X + (x_pos - viewOriginX()) * (CELL_SIZE + CELL_SPACING) + CELL_SIZE / 2 - 10;
+        int playerY = GRID_START_Y + (y_pos - viewOriginY()) * (CELL_SIZE + CELL_SPACING) + CELL_SIZE / 2 - 10;
         
         // Draw small green box (20x20) as per rpdesign.md
         DrawRectangle(playerX, playerY, 20, 20, green);
@@ -647,39 +692,77 @@ void Game::switchToBattle() {
     // Create a BattleScene that uses the new Encounter class (Soulseer architecture)
     class BattleScene : public Scene {
     public:
-        // No longer need encounter pointer with ECS
+        BattleHandle battle = nullptr;
+        
+        // Selection and click state belong to this battle, not the process
+        bool right_clicking = false;
+        float right_click_timer = 0.0f;
+        int selected_entity = -1;        // Unit the action bar and Q/W/E/R act on
+        std::vector<int> selection;      // All selected units, selected_entity first
+        bool left_dragging = false;
+        Vector2 drag_start = {0, 0};     // Screen space
         
         BattleScene() {}
         
         ~BattleScene() {
-            cleanup_battle_system();
+            battle_destroy(battle);
         }
         
         void onEnter() override {
             std::cout << "Entering Battle Scene (ECS style)" << std::endl;
-            initialize_battle_system();
+            // Each battle gets its own seed from the spawn stream
+            battle = battle_create(game->rng.stream(RNG_SPAWN).next_u64(), 0);
+            game->saveRandomState();
+            if (game->stressTest) {
+                start_battle_stress_test(battle, "stress_report.csv");
+            }
         }
         
         void update() override {
-            update_battle_system();
+            battle_handle_input(battle);
+            battle_step(battle, 1);
             
             // MOBA-style controls adapted for ECS
             Vector2 mousePos = GetMousePosition();
-            static bool right_clicking = false;
-            static float right_click_timer = 0.0f;
-            static int selected_entity = -1;
-            static const float LONG_CLICK_THRESHOLD = 0.3f;
+            battle_screen_to_world(battle, &mousePos.x, &mousePos.y);  // Units live in world space
+            const float LONG_CLICK_THRESHOLD = 0.3f;
             
-            // Left click - Unit selection (player units only)
+            // Left click - Unit selection (player units only), drag for a selection box
+            const float DRAG_THRESHOLD = 5.0f;
             if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                int clicked_entity = get_entity_at_position(mousePos.x, mousePos.y, 0); // side 0 = player
-                if (clicked_entity != -1) {
-                    selected_entity = clicked_entity;
-                    std::cout << "Selected entity: " << clicked_entity << std::endl;
+                left_dragging = true;
+                drag_start = GetMousePosition();
+            }
+            if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON) && left_dragging) {
+                left_dragging = false;
+                Vector2 drag_end = GetMousePosition();
+                if (fabsf(drag_end.x - drag_start.x) < DRAG_THRESHOLD && fabsf(drag_end.y - drag_start.y) < DRAG_THRESHOLD) {
+                    int clicked_entity = get_entity_at_position(battle, mousePos.x, mousePos.y, 0); // side 0 = player
+                    selection.clear();
+                    if (clicked_entity != -1) selection.push_back(clicked_entity);
+                } else {
+                    Vector2 world_start = drag_start;
+                    battle_screen_to_world(battle, &world_start.x, &world_start.y);
+                    select_box(world_start, mousePos);
+                }
+                
+                selected_entity = selection.empty() ? -1 : selection[0];
+                if (selected_entity != -1) {
+                    std::cout << "Selected " << selection.size() << " unit(s), leader " << selected_entity << std::endl;
                 } else {
-                    selected_entity = -1;
                     std::cout << "Deselected entity" << std::endl;
                 }
+                set_action_bar_entity(battle, selected_entity);
+            }
+            
+            // Q/W/E/R - skills of the selected unit
+            if (selected_entity != -1) {
+                const int skill_keys[4] = {KEY_Q, KEY_W, KEY_E, KEY_R};
+                for (int slot = 0; slot < 4; slot++) {
+                    if (IsKeyPressed(skill_keys[slot])) {
+                        cast_entity_ability(battle, selected_entity, slot);
+                    }
+                }
             }
             
             // Right click with long-click support  
@@ -693,9 +776,8 @@ void Game::switchToBattle() {
                     right_click_timer += GetFrameTime();
                     
                     if (right_click_timer >= LONG_CLICK_THRESHOLD) {
-                        // Long click - continuous movement
-                        set_entity_target_location(selected_entity, mousePos.x, mousePos.y);
-                        // Don't spam console during long click
+                        // Long click - continuous movement; repeats while the cursor rests are coalesced
+                        command_group_move(battle, selection.data(), (int)selection.size(), mousePos.x, mousePos.y);
                     }
                 }
                 
@@ -705,13 +787,11 @@ void Game::switchToBattle() {
                         std::cout << "Right clicked at (" << mousePos.x << ", " << mousePos.y << ")" << std::endl;
                         
                         // Check for enemy at click position
-                        int target_enemy = get_entity_at_position(mousePos.x, mousePos.y, 1); // side 1 = enemy
+                        int target_enemy = get_entity_at_position(battle, mousePos.x, mousePos.y, 1); // side 1 = enemy
                         if (target_enemy != -1) {
-                            set_entity_target_enemy(selected_entity, target_enemy);
-                            std::cout << "Targeting enemy entity: " << target_enemy << std::endl;
+                            command_group_attack(battle, selection.data(), (int)selection.size(), target_enemy);
                         } else {
-                            set_entity_target_location(selected_entity, mousePos.x, mousePos.y);
-                            std::cout << "Moving to location (" << mousePos.x << ", " << mousePos.y << ")" << std::endl;
+                            command_group_move(battle, selection.data(), (int)selection.size(), mousePos.x, mousePos.y);
                         }
                     }
                     right_clicking = false;
@@ -813,16 +893,36 @@ void Game::switchToBattle() {
             */
         }
         
+        // Fills selection with every player unit in the box (world space)
+        void select_box(Vector2 a, Vector2 b) {
+            if (selection.size() < 64) selection.resize(64);
+            int found = select_entities_in_rect(battle, a.x, a.y, b.x, b.y, 0, selection.data(), (int)selection.size());
+            if (found > (int)selection.size()) {
+                selection.resize(found);
+                found = select_entities_in_rect(battle, a.x, a.y, b.x, b.y, 0, selection.data(), found);
+            }
+            selection.resize(found);
+        }
+        
         void draw() override {
             // Clear background with battle color
             Color battleGray; battleGray.r = 64; battleGray.g = 64; battleGray.b = 64; battleGray.a = 255;
             ClearBackground(battleGray);
             
-            render_battle_system();
+            battle_render(battle);
+            
+            // Selection box while dragging
+            if (left_dragging) {
+                Vector2 now = GetMousePosition();
+                Rectangle box = {fminf(drag_start.x, now.x), fminf(drag_start.y, now.y),
+                                 fabsf(now.x - drag_start.x), fabsf(now.y - drag_start.y)};
+                DrawRectangleRec(box, Fade(GREEN, 0.15f));
+                DrawRectangleLinesEx(box, 1.0f, GREEN);
+            }
             
             // Draw controls (MOBA-style)
             Color white; white.r = 255; white.g = 255; white.b = 255; white.a = 255;
-            DrawText("Left Click: Select Units | Right Click: Move/Attack | Hold Right: Continuous Move", 10, 680, 20, white);
+            DrawText("Left Click/Drag: Select Units | Right Click: Move/Attack | Hold Right: Continuous Move | Arrows/Wheel: Camera", 10, 680, 20, white);
         }
     };
     
@@ -877,9 +977,65 @@ void Game::updateFadeTransition() {
     }
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
+    // --stress-headless: run the battle stress test without opening a window
+    // --stress: run it windowed so rendering cost is included
+    // --asset-bench: compare texture load time from PNGs and from the cooked pack
+    // --dungeon-bench: time whole-floor and chunked generation on a 256x256 floor
+    // --seed N: start from master seed N instead of the saved one
+    uint64_t seed = 1;
+    bool hasSeed = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) != "--seed") continue;
+        std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+        size_t used = 0;
+        try {
+            // stoull accepts a leading '-' and wraps it, so reject that up front
+            if (value.empty() || value[0] == '-') throw std::invalid_argument(value);
+            seed = std::stoull(value, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != value.size()) {
+            std::cerr << "Usage: " << argv[0] << " [--seed N] where N is an unsigned 64-bit integer (got \"" << value << "\")" << std::endl;
+            return 1;
+        }
+        hasSeed = true;
+    }
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--stress-headless") {
+            run_headless_stress_test("stress_report.csv", seed);
+            return 0;
+        }
+        if (arg == "--asset-bench") {
+            // Texture uploads need a GL context, so open a hidden window
+            SetConfigFlags(FLAG_WINDOW_HIDDEN);
+            InitWindow(1280, 720, "Searching");
+            run_asset_load_benchmark();
+            CloseWindow();
+            return 0;
+        }
+        if (arg == "--dungeon-bench") {
+            // Whole-floor generation, then chunk generation and LRU eviction as the
+            // dungeon scene uses it, both on a 256x256 floor
+            benchmark_floor_generation(256);
+            benchmark_chunked_floor(256);
+            return 0;
+        }
+    }
+    
     Game game;
+    if (hasSeed) {
+        game.seedRandom(seed);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--stress") {
+            game.stressTest = true;
+        }
+    }
     game.run();
     return 0;
 }
\ No newline at end of file
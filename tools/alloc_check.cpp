@@ -0,0 +1,87 @@
+// alloc_check.cpp - Fails if steady-state battle frames allocate from the heap
+//
+// Usage: alloc_check [units_per_side] [warm_frames] [measured_frames]
+// Built with SEARCHING_COUNT_ALLOCATIONS so heap_allocation_count() is live. Two
+// armies are spawned in contact, every knight keeps casting its skills and fallen
+// skeletons are replaced between frames, so the fight stays at full size. After the
+// warm-up frames have grown every pool (at least one cycle of the longest skill
+// cooldown), any heap allocation inside battle_step is an error. Spawning happens
+// outside battle_step and isn't counted. Run from the project (or build) root so
+// data/ resolves.
+
+#include "../src/BattleSystem.h"
+#include "../src/FrameArena.h"
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+int main(int argc, char** argv) {
+    int units_per_side = argc > 1 ? std::atoi(argv[1]) : 300;
+    int warm_frames = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int measured_frames = argc > 3 ? std::atoi(argv[3]) : 600;
+    
+    if (!HEAP_ALLOCATIONS_COUNTED) {
+        std::cerr << "alloc_check must be built with SEARCHING_COUNT_ALLOCATIONS" << std::endl;
+        return 2;
+    }
+    
+    BattleHandle battle = battle_create(1, 1);
+    
+    // Two dense blocks of 20 columns, 30 px apart, facing each other across a short
+    // gap so melee and skill hitboxes start landing on crowds at once
+    for (int i = 0; i < units_per_side; i++) {
+        float x = (float)(i % 20) * 30.0f;
+        float y = (float)(i / 20) * 30.0f;
+        spawn_player_at(battle, 200 + x, 200 + y);
+        spawn_skeleton_at_position(battle, 900 + x, 200 + y);
+    }
+    
+    // Selection reads the living units packed by the last step, so take one first
+    battle_step(battle, 1);
+    std::vector<int> knights(units_per_side + 64);
+    int knight_count = select_entities_in_rect(battle, -1e6f, -1e6f, 1e6f, 1e6f, 0,
+                                               knights.data(), (int)knights.size());
+    knight_count = std::min(knight_count, (int)knights.size());
+    if (knight_count == 0) {
+        std::cerr << "No knights to cast with; check data/temp_data is reachable" << std::endl;
+        battle_destroy(battle);
+        return 2;
+    }
+    
+    size_t total_allocs = 0, worst_frame = 0;
+    int frames_with_allocs = 0;
+    int reinforcements = 0;
+    for (int frame = 0; frame < warm_frames + measured_frames; frame++) {
+        for (int missing = units_per_side - battle_alive_count(battle, 1); missing > 0; missing--) {
+            int i = reinforcements++ % units_per_side;
+            spawn_skeleton_at_position(battle, 900 + (float)(i % 20) * 30.0f, 200 + (float)(i / 20) * 30.0f);
+        }
+        for (int i = 0; i < knight_count; i++) {
+            cast_entity_ability(battle, knights[i], frame % 4);
+        }
+        
+        size_t before = heap_allocation_count();
+        battle_step(battle, 1);
+        size_t allocs = heap_allocation_count() - before;
+        if (frame < warm_frames || allocs == 0) continue;
+        
+        total_allocs += allocs;
+        worst_frame = std::max(worst_frame, allocs);
+        frames_with_allocs++;
+    }
+    
+    std::cout << measured_frames << " frames after " << warm_frames << " warm-up, " << units_per_side
+              << " units per side (" << battle_alive_count(battle, 0) << "/" << battle_alive_count(battle, 1)
+              << " left, " << reinforcements << " reinforcements): " << total_allocs << " heap allocations on " << frames_with_allocs
+              << " frames, worst " << worst_frame << std::endl;
+    battle_destroy(battle);
+    
+    if (total_allocs > 0) {
+        std::cout << "FAIL: steady-state battle frames must not allocate" << std::endl;
+        return 1;
+    }
+    std::cout << "OK" << std::endl;
+    return 0;
+}
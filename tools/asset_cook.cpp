@@ -0,0 +1,132 @@
+// asset_cook.cpp - Cooks every PNG under an assets directory into one texture pack
+//
+// Usage: asset_cooker <assets_dir> <output_pack>
+// Run from the project root so index paths match what the game loads
+// ("assets/player/Idle.png"). Files whose PNG hash matches the existing pack
+// are copied over without being decoded again.
+
+#include "../src/AssetPack.h"
+
+#include <iostream>
+#include <filesystem>
+#include <chrono>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+struct CookedAsset {
+    PackEntry entry;
+    std::vector<unsigned char> pixels;
+};
+
+static bool read_file(const fs::path& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamsize size = file.tellg();
+    bytes.resize(size > 0 ? (size_t)size : 0);
+    file.seekg(0);
+    return (bool)file.read((char*)bytes.data(), size);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "Usage: asset_cooker <assets_dir> <output_pack>" << std::endl;
+        return 1;
+    }
+    std::string assets_dir = argv[1];
+    std::string output_path = argv[2];
+    auto start = std::chrono::steady_clock::now();
+
+    // Previous pack, used to skip PNGs that haven't changed
+    AssetPack previous;
+    previous.open(output_path);
+
+    std::vector<std::string> paths;
+    for (const auto& item : fs::recursive_directory_iterator(assets_dir)) {
+        if (!item.is_regular_file()) continue;
+        std::string ext = item.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".png") paths.push_back(item.path().generic_string());
+    }
+    std::sort(paths.begin(), paths.end());  // Index must be sorted for AssetPack::find
+
+    std::vector<CookedAsset> cooked;
+    int decoded = 0, reused = 0;
+    for (const std::string& path : paths) {
+        if (path.size() >= sizeof(PackEntry::path)) {
+            std::cout << "Skipping, path too long for the index: " << path << std::endl;
+            continue;
+        }
+
+        std::vector<unsigned char> png;
+        if (!read_file(path, png)) {
+            std::cout << "Failed to read: " << path << std::endl;
+            continue;
+        }
+
+        CookedAsset asset = {};
+        strncpy(asset.entry.path, path.c_str(), sizeof(asset.entry.path) - 1);
+        asset.entry.content_hash = fnv1a_hash(png.data(), png.size());
+
+        const PackEntry* old = previous.is_open() ? previous.find(path) : nullptr;
+        if (old && old->content_hash == asset.entry.content_hash) {
+            const unsigned char* src = previous.pixels(*old);
+            asset.pixels.assign(src, src + old->size);
+            asset.entry.width = old->width;
+            asset.entry.height = old->height;
+            reused++;
+        } else {
+            Image image = LoadImageFromMemory(".png", png.data(), (int)png.size());
+            if (image.data == nullptr) {
+                std::cout << "Failed to decode: " << path << std::endl;
+                continue;
+            }
+            ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            const unsigned char* src = (const unsigned char*)image.data;
+            asset.pixels.assign(src, src + (size_t)image.width * image.height * 4);
+            asset.entry.width = (uint32_t)image.width;
+            asset.entry.height = (uint32_t)image.height;
+            UnloadImage(image);
+            decoded++;
+        }
+        asset.entry.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        asset.entry.size = (uint32_t)asset.pixels.size();
+        cooked.push_back(std::move(asset));
+    }
+    previous.close();  // Unmap before the file is overwritten
+
+    // Assign offsets: header, index, then 16-byte aligned pixel blobs
+    uint64_t offset = sizeof(PackHeader) + cooked.size() * sizeof(PackEntry);
+    for (CookedAsset& asset : cooked) {
+        offset = (offset + 15) & ~uint64_t(15);
+        asset.entry.offset = offset;
+        offset += asset.entry.size;
+    }
+
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cout << "Failed to write: " << output_path << std::endl;
+        return 1;
+    }
+    PackHeader header = {};
+    memcpy(header.magic, ASSET_PACK_MAGIC, 4);
+    header.version = ASSET_PACK_VERSION;
+    header.entry_count = (uint32_t)cooked.size();
+    out.write((const char*)&header, sizeof(header));
+    for (const CookedAsset& asset : cooked) {
+        out.write((const char*)&asset.entry, sizeof(PackEntry));
+    }
+    for (const CookedAsset& asset : cooked) {
+        static const char padding[16] = {};
+        uint64_t position = (uint64_t)out.tellp();
+        out.write(padding, (std::streamsize)(asset.entry.offset - position));
+        out.write((const char*)asset.pixels.data(), asset.pixels.size());
+    }
+    uint64_t total = (uint64_t)out.tellp();
+    out.close();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Cooked " << cooked.size() << " textures (" << decoded << " decoded, " << reused
+              << " unchanged) into " << output_path << ", " << total / 1024 << " KiB in " << ms << " ms" << std::endl;
+    return 0;
+}